@@ -0,0 +1,262 @@
+#include "AES/AESCTR.h"
+#include "WEM/WEMFamily.hpp"
+#include "WEM/WEMOracle.hpp"
+#include "GF/GF28.h"
+#include "linalg/SparseSystem.h"
+#include "utils/component.h"
+
+#include <iostream>
+#include <cstring>
+#include <cstdlib>
+#include <string>
+#include <functional>
+#include <vector>
+#include <chrono>
+
+using std::cout;
+using std::endl;
+
+using component::printx;
+
+// Recovers the secret S-box of WEM16<1, 1> (or WEM8<1, 1> with --width 8).
+//
+// The plaintexts fix every word holding a byte of the diagonal 0, 5, 10, 15.
+// The PN1 whitening key is zero, so after the first S-layer and the one-round
+// P1 column 0 is constant, and so are the middle words over it. The one-round
+// P2 moves byte (r, 0) to (r, -r), hence for Y = S^-1(C) and each row r
+//   InvMC row r . (column -r of Y) = kappa_r,
+// a constant of the key. The unknowns are the Width / 8 bytes of S^-1(w) for
+// every word value w (2^17 for 16-bit words) and the four kappa_r. The
+// solutions are a * S^-1 + b with a scalar a and a constant b per byte, so
+// the rank to reach is unknowns - (Width / 8 + 1).
+//
+// Every ciphertext adds four 5-term equations to a sparse system as it comes
+// back, and queries stop once every word value has been seen minDegree times
+// (raised, and the stream continued, while the rank falls short). The sparse
+// phase of linalg::solveSparse reduces the whole 16-bit system in seconds and
+// about 150 MB; anything left goes to the parallel dense core (WEM_THREADS).
+//   wem16 [--width 8|16] [--degree D]
+
+static void info(std::string s)
+{
+    static int steps;
+    cout << "[" << steps << "] " << s << endl;
+    ++steps;
+    return;
+}
+
+static double seconds(std::chrono::steady_clock::time_point since)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - since).count();
+}
+
+static const unsigned char invMC[4][4] = {
+    { 0x0e, 0x0b, 0x0d, 0x09 },
+    { 0x09, 0x0e, 0x0b, 0x0d },
+    { 0x0d, 0x09, 0x0e, 0x0b },
+    { 0x0b, 0x0d, 0x09, 0x0e },
+};
+
+// the exit status: 0 once the S-box is recovered and checked, 1 on any error
+template <int Width>
+static int attack(AESCTR& rng, int minDegree)
+{
+    using Cipher = GenericWEM<Width, false, 1, 1>;
+
+    constexpr int halves = Width / 8;                   // bytes per word
+    constexpr int values = 1 << Width;
+    constexpr int kappa = halves * values;              // column of kappa_0
+    constexpr int unknowns = kappa + 4;
+    constexpr int expectedRank = unknowns - (halves + 1);
+
+    info("Setup oracle");
+    unsigned char secretKey[16];
+    rng.fill(secretKey, 16);
+
+    typename Cipher::Key wemKey(secretKey);
+    auto& wemHandler = Cipher::instance();
+    auto oracle = makeOracle(wemHandler, wemKey);
+    auto p1Oracle  = std::bind(&Cipher::template PLayer<0>, std::ref(wemHandler), std::placeholders::_1);
+    auto p2Oracle  = std::bind(&Cipher::template PLayer<1>, std::ref(wemHandler), std::placeholders::_1);
+
+
+    cout << endl << "===== test vector =====" << endl;
+    unsigned char testvector[] = { '-', '#', '-', ' ', 'c', 'o', 'r', 'r', 'e', 'c', 't', '!', ' ', '-', '#', '-' };
+    wemHandler.WEMEncrypt(testvector, testvector, wemKey);
+    printx(testvector); cout << endl;
+    wemHandler.WEMDecrypt(testvector, testvector, wemKey);
+    for (int _vi = 0; _vi < 16; ++_vi) { cout << testvector[_vi]; } cout << endl;
+    cout << "====== end  test ======" << endl << endl;
+
+
+    info("Start Attack");
+
+    info("Query oracle");
+
+    // words over the diagonal keep the bytes of base
+    unsigned char base[16], fixed[16] = { 0x00 };
+    rng.fill(base, 16);
+    for (const int b : { 0, 5, 10, 15 })
+        for (int h = 0; h < halves; ++h) fixed[b / halves * halves + h] = 0xff;
+
+    SparseSystem eqs(unknowns);
+    eqs.reserve(static_cast<long long>(minDegree) * values, 5ll * minDegree * values);
+    std::vector<int> degree(values, 0);
+
+    constexpr int chunk = 4096;
+    std::vector<unsigned char> plaintexts(16 * chunk), ciphertexts(16 * chunk);
+    // streams queries until every word value has been seen minDegree times
+    auto query = [&]() {
+        int uncovered = 0;
+        for (const int d : degree) uncovered += d < minDegree;
+        while (uncovered > 0) {
+            rng.fill(plaintexts.data(), 16 * chunk);
+            for (int t = 0; t < chunk; ++t)
+                for (int b = 0; b < 16; ++b)
+                    if (fixed[b]) plaintexts[16 * t + b] = base[b];
+            oracle.encrypt(ciphertexts.data(), plaintexts.data(), chunk);
+
+            for (int t = 0; t < chunk; ++t) {
+                const unsigned char *ciphertext = &ciphertexts[16 * t];
+                int word[16 / halves];
+                for (int w = 0; w < 16 / halves; ++w) {
+                    word[w] = 0;
+                    for (int h = 0; h < halves; ++h) word[w] |= ciphertext[halves * w + h] << (8 * h);
+                    if (++degree[word[w]] == minDegree) --uncovered;
+                }
+
+                for (int r = 0; r < 4; ++r) {
+                    const int col = (4 - r) % 4;
+                    int terms[5];
+                    unsigned char coefs[5];
+                    for (int i = 0; i < 4; ++i) {
+                        const int b = 4 * col + i;
+                        terms[i] = word[b / halves] * halves + b % halves;
+                        coefs[i] = invMC[r][i];
+                    }
+                    terms[4] = kappa + r;
+                    coefs[4] = 0x01;
+                    eqs.add(terms, coefs, 5);
+                }
+            }
+        }
+        return;
+    };
+
+    linalg::SolverOptions options;
+    options.strategy = linalg::Strategy::FourRussians;
+    std::vector< std::vector<unsigned char> > kernel;
+
+    // a few word values may still be pinned by too few equations: query on
+    for (int rank = 0; rank < expectedRank; ++minDegree) {
+        auto start = std::chrono::steady_clock::now();
+        query();
+        cout << oracle.queries() << " queries, " << eqs.rows() << " equations, "
+             << eqs.entries() << " entries (" << seconds(start) << " s)" << endl;
+
+        info("Sparse Elimination");
+        start = std::chrono::steady_clock::now();
+        rank = linalg::solveSparse(eqs, kernel, halves + 1, options);
+        cout << "rank: " << rank << " of " << expectedRank << " (" << seconds(start) << " s)" << endl;
+        if (rank > expectedRank || minDegree >= 16) {
+            info("Error");
+            return 1;
+        }
+    }
+
+    // y(w) for the kernel vector that is not a constant per byte: a * S^-1 + b
+    const std::vector<unsigned char> *v = nullptr;
+    for (const auto& x : kernel)
+        for (int col = 0; col < kappa && !v; ++col)
+            if (x[col] != x[col % halves]) v = &x;
+    if (!v) {
+        info("Error");
+        return 1;
+    }
+
+    std::vector<int> y(values), yinv(values, -1);
+    for (int w = 0; w < values; ++w) {
+        y[w] = 0;
+        for (int h = 0; h < halves; ++h) y[w] |= (*v)[w * halves + h] << (8 * h);
+        if (yinv[y[w]] >= 0) {
+            info("Error");
+            return 1;
+        }
+        yinv[y[w]] = w;
+    }
+
+    info("Search a, b");
+    const auto start = std::chrono::steady_clock::now();
+    unsigned char zeroText[16] = { 0x00 };
+    unsigned char filter[16];
+    oracle.encrypt(filter, zeroText);
+
+    // candidate S(x) = yinv[(x + b) / a], byte by byte
+    auto sbox = [&](int x, unsigned char inva, int b) {
+        int idx = 0;
+        for (int h = 0; h < halves; ++h)
+            idx |= GF28::mul(((x ^ b) >> (8 * h)) & 0xff, inva) << (8 * h);
+        return yinv[idx];
+    };
+    auto slayer = [&](unsigned char text[16], unsigned char inva, int b) {
+        for (int w = 0; w < 16 / halves; ++w) {
+            int x = 0;
+            for (int h = 0; h < halves; ++h) x |= text[halves * w + h] << (8 * h);
+            const int s = sbox(x, inva, b);
+            for (int h = 0; h < halves; ++h) text[halves * w + h] = (s >> (8 * h)) & 0xff;
+        }
+        return;
+    };
+
+    int cnt = 0;
+    for (int a = 0x01; a <= 0xff; ++a) {
+        const unsigned char inva = GF28::inv(a);
+        for (int b = 0; b < values; ++b) {
+            unsigned char text[16] = { 0x00 };
+            slayer(text, inva, b);
+            p1Oracle(text);
+            slayer(text, inva, b);
+            p2Oracle(text);
+            slayer(text, inva, b);
+            if (memcmp(text, filter, 16) != 0) continue;
+
+            for (int x = 0; x < values; ++x) {
+                if (sbox(x, inva, b) != wemKey.sbox(0)[x]) {
+                    info("Error");
+                    return 1;
+                }
+            }
+            ++cnt;
+        }
+    }
+    cout << "(" << seconds(start) << " s)" << endl;
+
+    info("Finish");
+    cout << "number of solutions: " << cnt << endl;
+
+    return cnt > 0 ? 0 : 1;
+}
+
+int main(int argc, char *argv[])
+{
+    int width = 16, minDegree = 4;
+    bool valid = true;
+    for (int i = 1; i < argc && valid; ++i) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "--width" && hasValue) width = atoi(argv[++i]);
+        else if (arg == "--degree" && hasValue) minDegree = atoi(argv[++i]);
+        else valid = false;
+    }
+
+    if (!valid || (width != 8 && width != 16)) {
+        std::cerr << "usage: " << argv[0] << " [--width 8|16] [--degree D]" << endl;
+        return 1;
+    }
+
+    const auto seed = AESCTR::defaultSeed();
+    auto rng = AESCTR::fromSeed(seed);
+    cout << "seed " << seed << endl;
+
+    return width == 8 ? attack<8>(rng, minDegree) : attack<16>(rng, minDegree);
+}
@@ -1,13 +1,19 @@
+#include "crypto/AES/AESCTR.h"
 #include "crypto/WEM/WEM_2EM.hpp"
+#include "crypto/WEM/WEMOracle.hpp"
+#include "crypto/WEM/RemoteOracle.h"
 #include "crypto/GF/GF28.h"
+#include "crypto/linalg/GF28Matrix.h"
+#include "crypto/linalg/IncrementalSolver.h"
 #include "crypto/utils/component.h"
 
 #include <iostream>
 #include <cstring>
 #include <string>
 #include <functional>
-#include <random>
 #include <cassert>
+#include <vector>
+#include <algorithm>
 
 using std::cout;
 using std::endl;
@@ -26,103 +32,30 @@ static void info(std::string s)
 }
 
 constexpr int eqSize = 256;
-inline void swapEq(unsigned char *eq1, unsigned char *eq2)
-{
-    unsigned char tmp[eqSize];
-    memcpy(tmp, eq1, eqSize);
-    memcpy(eq1, eq2, eqSize);
-    memcpy(eq2, tmp, eqSize);
-    return;
-}
-inline void xorEq(unsigned char *eq, unsigned char *eq1, unsigned char *eq2)
-{
-    unsigned char tmp[eqSize];
-    for (int i = 0; i < eqSize; ++i)
-        tmp[i] = eq1[i] ^ eq2[i];
-    memcpy(eq, tmp, eqSize);
-    return;
-}
-inline void mulEq(unsigned char *eq, unsigned char *eq1, unsigned char c)
-{
-    unsigned char tmp[eqSize];
-    for (int i = 0; i < eqSize; ++i)
-        tmp[i] = GF28::mul(eq1[i], c);
-    memcpy(eq, tmp, eqSize);
-    return;
-}
-int solveLinear(unsigned char linearEqs[eqNum][eqSize])
-{
-    int rank = 0;
-    for (int col = 0, firstRow = 0; col < eqSize; ++col) {
-        bool hasOne = false;
-
-        for (int row = firstRow; row < eqNum; ++row)
-            if (linearEqs[row][col]) {
-                swapEq(linearEqs[firstRow], linearEqs[row]);
-                hasOne = true;
-                break;
-            }
-
-        if (!hasOne) continue;
-
-        ++rank;
-        auto pivot = linearEqs[firstRow][col];
-        auto invPivot = GF28::inv(pivot);
-        mulEq(linearEqs[firstRow], linearEqs[firstRow], invPivot);
-
-        for (int row = 0; row < eqNum; ++row)
-            if (linearEqs[row][col] && row != firstRow) {
-                unsigned char tmp[eqSize];
-                mulEq(tmp, linearEqs[firstRow], linearEqs[row][col]);
-                xorEq(linearEqs[row], linearEqs[row], tmp);
-            }
-
-        ++firstRow;
-    }
-
-    // Triangle form
-    int oneRow;
-    for (oneRow = eqSize - 1; oneRow >= 0; --oneRow) {
-        bool isAny = false;
-        for (int col = 0; col < eqSize; ++col)
-            if (linearEqs[oneRow][col]) {
-                isAny = true;
-                break;
-            }
-        if (isAny) break;
-    }
-    while (!linearEqs[oneRow][oneRow]) {
-        for (int i = oneRow - 1; i < eqSize; ++i)
-            if (linearEqs[oneRow][i]) {
-                swapEq(linearEqs[i], linearEqs[oneRow]);
-                break;
-            }
-
-        --oneRow;
-    }
-
-    return rank;
-}
+constexpr int expectedRank = eqSize - 2; // the solution space is { a * S^-1 + b }
 
 int main()
 {
     info("Setup oracle");
-    std::random_device rd;
-    std::default_random_engine randomGen(rd());
-    std::uniform_int_distribution<int> dist(0, 255);
+    const auto seed = AESCTR::defaultSeed();
+    auto rng = AESCTR::fromSeed(seed);
+    cout << "seed " << seed << endl;
     unsigned char secretKey[16];
-    for (int i = 0; i < 16; ++i) secretKey[i] = static_cast<unsigned char>(dist(randomGen));
+    rng.fill(secretKey, 16);
 
     WEMKey wemKey(secretKey);
     auto& wemHandler = WEM<1, 2>::instance();
-    auto oracle = std::bind(&WEM<1, 2>::WEMEncrypt, std::ref(wemHandler), std::placeholders::_1, std::placeholders::_2, wemKey);
-    auto p1Oracle  = std::bind(&WEM<1, 2>::PLayer<0>, std::ref(wemHandler), std::placeholders::_1);
-    auto p2Oracle  = std::bind(&WEM<1, 2>::PLayer<1>, std::ref(wemHandler), std::placeholders::_1);
+    // WEM_ORACLE sends the queries to oracled, set up with the same key
+    auto remote = RemoteOracle::fromEnvironment();
+    if (remote) remote->setup(oracleProtocol::wemSetup(secretKey, 1, 2));
+    auto oracle = selectOracle(makeOracle(wemHandler, wemKey), remote.get());
+    auto p1Oracle  = std::bind(&WEM<1, 2>::PLayer<WEM<1, 2>::PN1>, std::ref(wemHandler), std::placeholders::_1);
+    auto p2Oracle  = std::bind(&WEM<1, 2>::PLayer<WEM<1, 2>::PN2>, std::ref(wemHandler), std::placeholders::_1);
 
     //auto& wemHandler = WEM<2, 1>::instance();
-    //auto oracle = std::bind(&WEM<2, 1>::WEMEncrypt, std::ref(wemHandler), std::placeholders::_1, std::placeholders::_2, wemKey);
-    //auto p1Oracle  = std::bind(&WEM<2, 1>::PLayer<0>, std::ref(wemHandler), std::placeholders::_1);
-    //auto p2Oracle  = std::bind(&WEM<2, 1>::PLayer<1>, std::ref(wemHandler), std::placeholders::_1);
+    //auto oracle = makeOracle(wemHandler, wemKey);
+    //auto p1Oracle  = std::bind(&WEM<2, 1>::PLayer<WEM<2, 1>::PN1>, std::ref(wemHandler), std::placeholders::_1);
+    //auto p2Oracle  = std::bind(&WEM<2, 1>::PLayer<WEM<2, 1>::PN2>, std::ref(wemHandler), std::placeholders::_1);
 
 
     cout << endl << "===== test vector =====" << endl;
@@ -137,78 +70,81 @@ int main()
     info("Start Attack");
 
     info("Query oracle");
-    unsigned char eqs[eqNum][256];
-    memset(eqs, 0x00, sizeof(eqs));
+    GF28Matrix eqs(eqNum, eqSize);
+    IncrementalSolver solver(eqSize);
 
     unsigned char plaintext[16];
-    for (int i = 0; i < 16; ++i) plaintext[i] = static_cast<unsigned char>(dist(randomGen));
+    rng.fill(plaintext, 16);
 
-    int ocnt = 0;
     for (int j = 0; j < 256; ++j) eqs[0][j] = 0x01;
-    for (int firstEq = 1, i = 1; i < eqNum / 4; ++i) {
-        unsigned char ciphertext[16];
-        if (i % 256 == 0) {
-            plaintext[ 2] = static_cast<unsigned char>(dist(randomGen));
-            plaintext[ 7] = static_cast<unsigned char>(dist(randomGen));
+    solver.add(eqs[0]);
+    // the texts for the next pairs go through the oracle in one call: a single
+    // pair in process; for oracled the calls double up to a window of messages,
+    // so the early stop wastes at most about as many queries as it used
+    const int lookahead = std::max(1, oracle.batch() / 2);
+    std::vector<unsigned char> plaintexts(32 * lookahead), ciphertexts(32 * lookahead);
+    for (int firstEq = 1, i = 1, next = 0, ready = 0, ahead = 1; i < eqNum / 4; ++i, ++next) {
+        if (next == ready) {
+            ready = std::min(ahead, eqNum / 4 - i);
+            ahead = std::min(2 * ahead, lookahead);
+            for (int j = 0; j < ready; ++j) {
+                if ((i + j) % 256 == 0) {
+                    plaintext[ 2] = rng.next8();
+                    plaintext[ 7] = rng.next8();
+                }
+
+                // pair i + j holds the texts for i + j - 1 and i + j
+                for (int t = 0; t < 2; ++t) {
+                    unsigned char *text = &plaintexts[32 * j + 16 * t];
+                    memcpy(text, plaintext, 16);
+                    text[0] = (i + j - 1 + t) & 0xff;
+                    text[5] = (i + j - 1 + t) & 0xff;
+                }
+            }
+            oracle.encrypt(ciphertexts.data(), plaintexts.data(), 2 * ready);
+            next = 0;
         }
 
-        plaintext[0] = (i - 1) & 0xff;
-        plaintext[5] = (i - 1) & 0xff;
-        oracle(ciphertext, plaintext);
-        ++ocnt;
-
-        eqs[firstEq + 0][ciphertext[0]] ^= 0x0d;
-        eqs[firstEq + 0][ciphertext[1]] ^= 0x09;
-        eqs[firstEq + 0][ciphertext[2]] ^= 0x0e;
-        eqs[firstEq + 0][ciphertext[3]] ^= 0x0b;
-
-        eqs[firstEq + 1][ciphertext[4]] ^= 0x09;
-        eqs[firstEq + 1][ciphertext[5]] ^= 0x0e;
-        eqs[firstEq + 1][ciphertext[6]] ^= 0x0b;
-        eqs[firstEq + 1][ciphertext[7]] ^= 0x0d;
-
-        eqs[firstEq + 2][ciphertext[8]] ^= 0x0e;
-        eqs[firstEq + 2][ciphertext[9]] ^= 0x0b;
-        eqs[firstEq + 2][ciphertext[10]] ^= 0x0d;
-        eqs[firstEq + 2][ciphertext[11]] ^= 0x09;
-
-        eqs[firstEq + 3][ciphertext[12]] ^= 0x0b;
-        eqs[firstEq + 3][ciphertext[13]] ^= 0x0d;
-        eqs[firstEq + 3][ciphertext[14]] ^= 0x09;
-        eqs[firstEq + 3][ciphertext[15]] ^= 0x0e;
-
-        plaintext[0] = i & 0xff;
-        plaintext[5] = i & 0xff;
-        oracle(ciphertext, plaintext);
-        ++ocnt;
-
-        eqs[firstEq + 0][ciphertext[0]] ^= 0x0d;
-        eqs[firstEq + 0][ciphertext[1]] ^= 0x09;
-        eqs[firstEq + 0][ciphertext[2]] ^= 0x0e;
-        eqs[firstEq + 0][ciphertext[3]] ^= 0x0b;
-
-        eqs[firstEq + 1][ciphertext[4]] ^= 0x09;
-        eqs[firstEq + 1][ciphertext[5]] ^= 0x0e;
-        eqs[firstEq + 1][ciphertext[6]] ^= 0x0b;
-        eqs[firstEq + 1][ciphertext[7]] ^= 0x0d;
-
-        eqs[firstEq + 2][ciphertext[8]] ^= 0x0e;
-        eqs[firstEq + 2][ciphertext[9]] ^= 0x0b;
-        eqs[firstEq + 2][ciphertext[10]] ^= 0x0d;
-        eqs[firstEq + 2][ciphertext[11]] ^= 0x09;
-
-        eqs[firstEq + 3][ciphertext[12]] ^= 0x0b;
-        eqs[firstEq + 3][ciphertext[13]] ^= 0x0d;
-        eqs[firstEq + 3][ciphertext[14]] ^= 0x09;
-        eqs[firstEq + 3][ciphertext[15]] ^= 0x0e;
+        for (int t = 0; t < 2; ++t) {
+            const unsigned char *ciphertext = &ciphertexts[32 * next + 16 * t];
+            eqs[firstEq + 0][ciphertext[0]] ^= 0x0d;
+            eqs[firstEq + 0][ciphertext[1]] ^= 0x09;
+            eqs[firstEq + 0][ciphertext[2]] ^= 0x0e;
+            eqs[firstEq + 0][ciphertext[3]] ^= 0x0b;
+
+            eqs[firstEq + 1][ciphertext[4]] ^= 0x09;
+            eqs[firstEq + 1][ciphertext[5]] ^= 0x0e;
+            eqs[firstEq + 1][ciphertext[6]] ^= 0x0b;
+            eqs[firstEq + 1][ciphertext[7]] ^= 0x0d;
+
+            eqs[firstEq + 2][ciphertext[8]] ^= 0x0e;
+            eqs[firstEq + 2][ciphertext[9]] ^= 0x0b;
+            eqs[firstEq + 2][ciphertext[10]] ^= 0x0d;
+            eqs[firstEq + 2][ciphertext[11]] ^= 0x09;
+
+            eqs[firstEq + 3][ciphertext[12]] ^= 0x0b;
+            eqs[firstEq + 3][ciphertext[13]] ^= 0x0d;
+            eqs[firstEq + 3][ciphertext[14]] ^= 0x09;
+            eqs[firstEq + 3][ciphertext[15]] ^= 0x0e;
+        }
 
+        for (int k = 0; k < 4; ++k) solver.add(eqs[firstEq + k]);
         firstEq += 4;
+
+        // equations are reduced as they arrive, stop once no more can help
+        if (solver.rank() >= expectedRank) break;
     }
 
-    cout << ocnt << " queries" << endl;
+    cout << oracle.queries() << " queries" << endl;
+    if (remote) {
+        const auto stats = remote->serverStats();
+        cout << remote->messages() << " messages, server: " << stats.messages << " messages, "
+             << stats.encrypted << " encrypted blocks" << endl;
+    }
 
     info("Gauss Elimination");
-    int rank = solveLinear(eqs);
+    int rank = solver.rank();
+    eqs = solver.reduced();
     cout << "rank: " << rank << endl;
 
     for (int row = 0; row < 256; ++row) {
@@ -223,66 +159,42 @@ int main()
         }
     }
 
-    int pos0 = -1;
-    int pos1 = -1;
-    for (int row = 0; row < 256; ++row) {
-        if (eqs[row][row] == 0) {
-            if (pos0 == -1) pos0 = row;
-            else {
-                pos1 = row;
-                break;
-            }
-        }
-
-        if (pos0 != -1 && pos1 != -1) break;
+    // every solution is c0 * kernel[0] + c1 * kernel[1]
+    auto kernel = eqs.nullspaceBasis();
+    if (kernel.rows() != 2) {
+        cout << "error" << endl;
+        return 0;
     }
 
     unsigned char zeroText[16] = { 0x00 };
     unsigned char filter[16];
-    oracle(filter, zeroText);
+    oracle.encrypt(filter, zeroText);
 
+    std::vector<unsigned char> candidate(kernel.rowStride());
     unsigned char recovered[256];
-    recovered[pos0] = 0x00;
-    recovered[pos1] = 0x01;
-    for (int row = 0; row < 256; ++row) {
-        if (eqs[row][row] == 0) continue;
-
-        unsigned char z = eqs[row][pos1]; // GF28::mul(eqs[row][pos0], 0x00) ^ GF28::mul(eqs[row][pos1], 0x01);
-        recovered[row] = z;
-    }
-
     int cnt = 0;
     for (int c0 = 0x00; c0 <= 0xff; ++c0) {
         for (int c1 = 0x00; c1 <= 0xff; ++c1) {
             if (c0 == c1) continue;
 
+            const unsigned char coefs[2] = { static_cast<unsigned char>(c0), static_cast<unsigned char>(c1) };
+            kernel.combineRows(candidate.data(), coefs);
+
             bool isTaken[256];
             memset(isTaken, 0, sizeof(isTaken));
-            isTaken[c0] = 1;
-            isTaken[c1] = 1;
-
-            recovered[pos0] = c0;
-            recovered[pos1] = c1;
 
             bool isFound = true;
-            for (int row = 0; row < 256; ++row) {
-                if (eqs[row][row] == 0) continue;
-
-                unsigned char z = GF28::mul(eqs[row][pos0], c0) ^ GF28::mul(eqs[row][pos1], c1);
-                if (isTaken[z]) {
+            for (int i = 0x00; i <= 0xff; ++i) {
+                if (isTaken[candidate[i]]) {
                     isFound = false;
                     break;
                 }
-                isTaken[z] = 1;
-
-                recovered[row] = z;
+                isTaken[candidate[i]] = 1;
             }
             if (!isFound) continue;
 
-            unsigned char rec[256];
             for (int i = 0x00; i <= 0xff; ++i)
-                rec[recovered[i]] = i & 0xff;
-            memcpy(recovered, rec, 256);
+                recovered[candidate[i]] = i & 0xff;
 
             for (int ti = 0; ti < 16; ++ti) zeroText[ti] = recovered[0x00];
             p1Oracle(zeroText);
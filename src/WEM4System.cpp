@@ -0,0 +1,70 @@
+#include "WEM4System.h"
+#include "utils/component.h"
+
+#include <cstring>
+
+void wem4System::baseTexts(unsigned char p1[16], unsigned char p2[16], AESCTR& rng)
+{
+    rng.fill(p1, 16);
+    const unsigned char randc = rng.next8();
+    memcpy(p2, p1, 16);
+    p1[13] = p1[12];
+    p1[14] = p1[12];
+    p2[12] = randc;
+    p2[13] = randc;
+    p2[14] = randc;
+    return;
+}
+
+void wem4System::pairPlaintexts(unsigned char pair[32], const unsigned char p1[16], const unsigned char p2[16], int i)
+{
+    auto plain1 = pair, plain2 = pair + 16;
+    memcpy(plain1, p1, 16);
+    memcpy(plain2, p2, 16);
+    plain1[0] = (i >> 8) & 0xff;
+    plain1[1] = i & 0xff;
+    plain2[0] = (i >> 8) & 0xff;
+    plain2[1] = i & 0xff;
+
+    component::invSR(plain1);
+    component::invSR(plain2);
+    return;
+}
+
+void wem4System::swapWord(unsigned char t1[16], unsigned char t2[16])
+{
+    auto t1words = reinterpret_cast<unsigned int*>(t1);
+    auto t2words = reinterpret_cast<unsigned int*>(t2);
+    for (int i = 0; i < 4; ++i)
+        if (t1words[i] != t2words[i]) {
+            auto tmp = t1words[i];
+            t1words[i] = t2words[i];
+            t2words[i] = tmp;
+            break;
+        }
+    return;
+}
+
+// equation k reads column k / 2 of both texts (bytes 4 (k / 2) .. 4 (k / 2) + 3)
+static const unsigned char coefs[8][4] = {
+    { 0x01, 0x02, 0x03, 0x01 },
+    { 0x01, 0x01, 0x02, 0x03 },
+    { 0x01, 0x01, 0x02, 0x03 },
+    { 0x03, 0x01, 0x01, 0x02 },
+    { 0x02, 0x03, 0x01, 0x01 },
+    { 0x03, 0x01, 0x01, 0x02 },
+    { 0x02, 0x03, 0x01, 0x01 },
+    { 0x01, 0x02, 0x03, 0x01 },
+};
+
+void wem4System::addEquations(GF28Matrix& eqs, int first, unsigned char pair[32])
+{
+    component::SR(pair);
+    component::SR(pair + 16);
+
+    for (int k = 0; k < 8; ++k)
+        for (int t = 0; t < 2; ++t)
+            for (int i = 0; i < 4; ++i)
+                eqs[first + k][pair[16 * t + 4 * (k / 2) + i]] ^= coefs[k][i];
+    return;
+}
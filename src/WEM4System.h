@@ -0,0 +1,30 @@
+#pragma once
+
+#include "AES/AESCTR.h"
+#include "linalg/GF28Matrix.h"
+
+// The chosen texts and equations of the WEM<2, 2> attack (wem4), shared with
+// the solver benchmarks so they measure the system the attack builds.
+//
+// Pair i (0..0xffff) is two plaintexts that differ only in bytes 12..14, with
+// i in bytes 0, 1 before the final ShiftRows. Both are encrypted, the first
+// differing word of the ciphertexts is swapped, and both are decrypted; the
+// two results give eight equations in the unknown S-box.
+namespace wem4System {
+    constexpr int eqNum = 1 + (1 << 9); // 1 for the special equation
+    constexpr int eqSize = 256;
+    constexpr int pairs = 1 << 16;
+
+    // the two base plaintexts, drawn from rng
+    void baseTexts(unsigned char p1[16], unsigned char p2[16], AESCTR& rng);
+
+    // both plaintexts of pair i, 32 bytes, ready for the encryption oracle
+    void pairPlaintexts(unsigned char pair[32], const unsigned char p1[16], const unsigned char p2[16], int i);
+
+    // swaps the first 4-byte word in which the two ciphertexts differ
+    void swapWord(unsigned char t1[16], unsigned char t2[16]);
+
+    // the eight equations of a decrypted pair (32 bytes, ShiftRows applied in
+    // place) xored into rows first .. first + 7 of eqs
+    void addEquations(GF28Matrix& eqs, int first, unsigned char pair[32]);
+}
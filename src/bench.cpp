@@ -0,0 +1,129 @@
+#include "bench.h"
+#include "linalg/GF28Matrix.h"
+#include "utils/cpu.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using std::cout;
+using std::endl;
+
+// Solver benchmark. Every engine runs on the same pre-generated WEM<2, 2>
+// systems (fixed seeds): warmup solves first, then one sample per solve in ns
+// and TSC cycles, with the copy of the system outside the timed region.
+//
+//   bench [--systems N] [--reps N] [--warmup N] [--seed S] [--threads T] [--json]
+
+struct Engine {
+    const char *name;
+    linalg::SolverOptions options;
+};
+
+// one line per engine and mode; a new engine only needs its line here
+static std::vector<Engine> engines(int threads)
+{
+    using linalg::Strategy;
+    return {
+        { "naive",              { Strategy::Naive, threads } },
+        { "naive-deferred",     { Strategy::Naive, threads, false, true } },
+        { "graycode",           { Strategy::GrayCode, threads } },
+        { "graycode-deferred",  { Strategy::GrayCode, threads, false, true } },
+        { "blocked",            { Strategy::Blocked, threads } },
+        { "fourrussians",       { Strategy::FourRussians, threads } },
+        { "bitsliced",          { Strategy::Bitsliced, threads } },
+        { "structured",         { Strategy::FourRussians, threads, true } },
+    };
+}
+
+struct Summary {
+    int rank;
+    BenchSummary time;
+};
+
+static Summary run(const std::vector<GF28Matrix>& systems, const linalg::SolverOptions& options, int reps, int warmup)
+{
+    Summary s = {};
+    for (int i = 0; i < warmup; ++i)
+        for (const auto& system : systems) {
+            GF28Matrix m(system);
+            m.rref(options);
+        }
+
+    BenchSamples samples;
+    GF28Matrix m;
+    for (int i = 0; i < reps; ++i)
+        for (const auto& system : systems) {
+            m = system;
+            samples.time([&] { s.rank = m.rref(options); });
+        }
+    s.time = samples.summary();
+    return s;
+}
+
+int main(int argc, char **argv)
+{
+    int numSystems = 8, reps = 25, warmup = 3, threads = linalg::defaultThreads();
+    unsigned seed = 1;
+    bool json = false;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "--json") json = true;
+        else if (arg == "--systems" && hasValue) numSystems = std::max(1, atoi(argv[++i]));
+        else if (arg == "--reps" && hasValue) reps = std::max(1, atoi(argv[++i]));
+        else if (arg == "--warmup" && hasValue) warmup = std::max(0, atoi(argv[++i]));
+        else if (arg == "--seed" && hasValue) seed = static_cast<unsigned>(strtoul(argv[++i], nullptr, 10));
+        else if (arg == "--threads" && hasValue) threads = atoi(argv[++i]);
+        else {
+            std::cerr << "usage: " << argv[0] << " [--systems N] [--reps N] [--warmup N] [--seed S] [--threads T] [--json]" << endl;
+            return 1;
+        }
+    }
+
+    // system i only depends on seed + i
+    std::vector<GF28Matrix> systems(numSystems, GF28Matrix(benchEqNum, benchEqSize));
+    for (int i = 0; i < numSystems; ++i) {
+        auto rng = AESCTR::fromSeed(seed + i);
+        genBenchSystem(systems[i], rng);
+    }
+    const double matrixBytes = static_cast<double>(benchEqNum) * benchEqSize;
+
+    if (json) {
+        cout << "{" << endl;
+        cout << "  \"tier\": \"" << cpu::tierName(cpu::tier()) << "\"," << endl;
+        cout << "  \"threads\": " << threads << "," << endl;
+        cout << "  \"rows\": " << benchEqNum << ", \"cols\": " << benchEqSize << "," << endl;
+        cout << "  \"systems\": " << numSystems << ", \"reps\": " << reps << ", \"warmup\": " << warmup << ", \"seed\": " << seed << "," << endl;
+        cout << "  \"results\": [" << endl;
+    } else {
+        cout << "tier " << cpu::tierName(cpu::tier()) << ", threads " << threads << ", "
+             << numSystems << " systems x " << reps << " reps (seed " << seed << ")" << endl;
+        cout << "engine rank median_us p95_us p99_us mean_us cycles/byte" << endl;
+    }
+
+    const auto list = engines(threads);
+    for (size_t e = 0; e < list.size(); ++e) {
+        const auto s = run(systems, list[e].options, reps, warmup);
+        const double cyclesPerByte = s.time.medianCycles / matrixBytes;
+        if (json) {
+            cout << "    { \"engine\": \"" << list[e].name << "\", \"rank\": " << s.rank
+                 << ", \"samples\": " << numSystems * reps
+                 << ", \"median_us\": " << s.time.medianNs / 1000 << ", \"p95_us\": " << s.time.p95Ns / 1000
+                 << ", \"p99_us\": " << s.time.p99Ns / 1000 << ", \"mean_us\": " << s.time.meanNs / 1000
+                 << ", \"median_cycles\": " << s.time.medianCycles << ", \"cycles_per_byte\": " << cyclesPerByte
+                 << " }" << (e + 1 < list.size() ? "," : "") << endl;
+        } else {
+            cout << list[e].name << " " << s.rank << " " << s.time.medianNs / 1000 << " " << s.time.p95Ns / 1000 << " "
+                 << s.time.p99Ns / 1000 << " " << s.time.meanNs / 1000 << " " << cyclesPerByte << endl;
+        }
+    }
+
+    if (json) {
+        cout << "  ]" << endl;
+        cout << "}" << endl;
+    }
+    return 0;
+}
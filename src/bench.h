@@ -0,0 +1,111 @@
+#pragma once
+
+#include "AES/AESCTR.h"
+#include "WEM/WEM_2EM.hpp"
+#include "WEM/WEMOracle.hpp"
+#include "linalg/GF28Matrix.h"
+#include "WEM4System.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include <x86intrin.h>
+
+// The WEM<2, 2> attack system shared by the solver benchmarks: a fresh random
+// key, then the same queries as WEM4, one 513 x 256 system over GF(2^8).
+
+constexpr int benchEqNum = wem4System::eqNum;
+constexpr int benchEqSize = wem4System::eqSize;
+
+// fills eqs (benchEqNum x benchEqSize, cleared) with the system of a random key
+static void genBenchSystem(GF28Matrix& eqs, AESCTR& rng)
+{
+    unsigned char secretKey[16];
+    rng.fill(secretKey, 16);
+
+    WEMKey wemKey(secretKey);
+    auto& wemHandler = WEM<2, 2>::instance();
+    auto oracle = makeOracle(wemHandler, wemKey);
+
+    unsigned char p1[16];
+    unsigned char p2[16];
+    wem4System::baseTexts(p1, p2, rng);
+
+    int eqCnt = 0;
+    for (int pair = 0; eqCnt < benchEqNum - 1; ++pair) {
+        // both texts of a pair go through the cipher as one batch
+        unsigned char plain[32];
+        unsigned char cipher[32];
+        wem4System::pairPlaintexts(plain, p1, p2, pair);
+        oracle.encrypt(cipher, plain, 2);
+        wem4System::swapWord(cipher, cipher + 16);
+        oracle.decrypt(plain, cipher, 2);
+
+        wem4System::addEquations(eqs, eqCnt, plain);
+        eqCnt += 8;
+    }
+    for (int i = 0; i < benchEqSize; ++i) eqs[eqCnt][i] = 0x01; // special equation
+    return;
+}
+
+/**** timing ****/
+
+// TSC ticks, fenced so the solve cannot drift across the read; the TSC runs
+// at the nominal frequency, not the current core clock
+static inline uint64_t ticks()
+{
+    _mm_lfence();
+    const uint64_t t = __rdtsc();
+    _mm_lfence();
+    return t;
+}
+
+// nearest-rank percentile of sorted samples
+template <typename T>
+static T percentile(const std::vector<T>& sorted, double p)
+{
+    const size_t rank = static_cast<size_t>(std::ceil(p * sorted.size()));
+    return sorted[std::min(sorted.size(), std::max<size_t>(rank, 1)) - 1];
+}
+
+struct BenchSummary {
+    double medianNs, p95Ns, p99Ns, meanNs;
+    double medianCycles;
+};
+
+// one sample per timed call, in steady_clock ns and TSC cycles; set up the
+// work (copies, fresh systems) outside the call
+struct BenchSamples {
+    std::vector<double> ns;
+    std::vector<uint64_t> cycles;
+
+    template <typename F>
+    void time(F&& f)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        const uint64_t c0 = ticks();
+        f();
+        const uint64_t c1 = ticks();
+        const auto end = std::chrono::steady_clock::now();
+        ns.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+        cycles.push_back(c1 - c0);
+        return;
+    }
+
+    BenchSummary summary()
+    {
+        BenchSummary s = {};
+        std::sort(ns.begin(), ns.end());
+        std::sort(cycles.begin(), cycles.end());
+        s.medianNs = percentile(ns, 0.50);
+        s.p95Ns = percentile(ns, 0.95);
+        s.p99Ns = percentile(ns, 0.99);
+        double total = 0;
+        for (auto t : ns) total += t;
+        s.meanNs = total / ns.size();
+        s.medianCycles = static_cast<double>(percentile(cycles, 0.50));
+        return s;
+    }
+};
@@ -0,0 +1,101 @@
+#include "bench.h"
+#include "linalg/GF28Matrix.h"
+
+#include <iostream>
+#include <utility>
+
+using std::cout;
+using std::endl;
+
+constexpr int scalingReps = 5;
+
+static void print(const char *what, const BenchSummary& s)
+{
+    cout << what << " " << s.medianNs / 1e6 << " " << s.p95Ns / 1e6 << " " << s.p99Ns / 1e6 << " "
+         << s.meanNs / 1e6 << endl;
+    return;
+}
+
+// a fresh attack system per sample, generated outside the timed solve
+GF28Matrix eqs(benchEqNum, benchEqSize);
+static void benchAttack(AESCTR& rng, int warmup, int reps)
+{
+    BenchSamples samples;
+    for (int i = 0; i < warmup + reps; ++i) {
+        eqs.clear();
+        genBenchSystem(eqs, rng);
+        if (i < warmup) eqs.rref({ linalg::Strategy::Blocked });
+        else samples.time([] { eqs.rref({ linalg::Strategy::Blocked }); });
+    }
+    print("attack blocked", samples.summary());
+    return;
+}
+
+// dense random (2n + 1) x n system, the shape of the attack systems for a
+// larger S-box, solved by each engine
+static void benchScaling(int n)
+{
+    auto rng = AESCTR::fromSeed(n);
+    GF28Matrix sys(2 * n + 1, n);
+    for (int i = 0; i < sys.rows(); ++i)
+        rng.fill(sys[i], n);
+
+    const std::pair<const char*, linalg::Strategy> engines[] = {
+        { "naive", linalg::Strategy::Naive },
+        { "graycode", linalg::Strategy::GrayCode },
+        { "blocked", linalg::Strategy::Blocked },
+        { "fourrussians", linalg::Strategy::FourRussians },
+        { "bitsliced", linalg::Strategy::Bitsliced },
+    };
+    for (const auto& engine : engines) {
+        BenchSamples samples;
+        GF28Matrix m;
+        for (int i = 0; i < scalingReps; ++i) {
+            m = sys;
+            samples.time([&] { m.rref({ engine.second }); });
+        }
+        cout << n << " ";
+        print(engine.first, samples.summary());
+    }
+    return;
+}
+
+// sparse (2n + 1) x n system, 8 entries per row like a fresh attack
+// equation, solved dense and with the structured front end
+static void benchStructured(int n)
+{
+    auto rng = AESCTR::fromSeed(n);
+    GF28Matrix sys(2 * n + 1, n);
+    for (int i = 0; i < sys.rows(); ++i)
+        for (int k = 0; k < 8; ++k)
+            sys[i][rng.bounded(n)] ^= static_cast<unsigned char>(1 + rng.bounded(255));
+
+    for (bool structured : { false, true }) {
+        linalg::SolverOptions options = { linalg::Strategy::FourRussians };
+        options.structured = structured;
+        BenchSamples samples;
+        GF28Matrix m;
+        for (int i = 0; i < scalingReps; ++i) {
+            m = sys;
+            samples.time([&] { m.rref(options); });
+        }
+        cout << n << " ";
+        print(structured ? "sparse structured" : "sparse dense", samples.summary());
+    }
+    return;
+}
+
+int main()
+{
+    const auto seed = AESCTR::defaultSeed();
+    auto rng = AESCTR::fromSeed(seed);
+    cout << "seed " << seed << endl;
+    cout << "[n] system median_ms p95_ms p99_ms mean_ms" << endl;
+    benchAttack(rng, 100, 1000);
+
+    for (int n : { 256, 1024, 2048 })
+        benchScaling(n);
+    for (int n : { 256, 1024, 4096 })
+        benchStructured(n);
+    return 0;
+}
@@ -0,0 +1,65 @@
+#include "bench.h"
+#include "linalg/GF28Matrix.h"
+#include "linalg/Batch.h"
+
+#include <iostream>
+#include <utility>
+#include <vector>
+
+using std::cout;
+using std::endl;
+
+constexpr int batchSize = 1100;
+constexpr int batchReps = 5;
+
+// solves copies of systems, one after the other or as a batch, batchReps
+// times; one sample per pass over all systems
+static BenchSummary passes(const std::vector<GF28Matrix>& systems, linalg::Strategy strategy, bool batch, int threads)
+{
+    BenchSamples samples;
+    std::vector<GF28Matrix> work;
+    for (int i = 0; i < batchReps; ++i) {
+        work = systems;
+        samples.time([&] {
+            if (batch) {
+                linalg::rrefBatch(work, { strategy, threads });
+            } else {
+                for (auto& system : work)
+                    system.rref({ strategy, 1 });
+            }
+        });
+    }
+    return samples.summary();
+}
+
+int main()
+{
+    const auto seed = AESCTR::defaultSeed();
+    auto rng = AESCTR::fromSeed(seed);
+    cout << "seed " << seed << endl;
+    std::vector<GF28Matrix> systems(batchSize, GF28Matrix(benchEqNum, benchEqSize));
+    for (auto& system : systems)
+        genBenchSystem(system, rng);
+
+    const std::pair<const char*, linalg::Strategy> engines[] = {
+        { "naive", linalg::Strategy::Naive },
+        { "graycode", linalg::Strategy::GrayCode },
+        { "blocked", linalg::Strategy::Blocked },
+        { "fourrussians", linalg::Strategy::FourRussians },
+        { "bitsliced", linalg::Strategy::Bitsliced },
+    };
+    const std::pair<const char*, int> modes[] = {
+        { "serial", -1 }, // no batch
+        { "batch(1)", 1 },
+        { "batch(all)", 0 }, // threads = 0: one worker per core
+    };
+    // systems/s at the median pass, then the pass times
+    cout << "engine mode systems/s median_ms p95_ms p99_ms" << endl;
+    for (const auto& engine : engines)
+        for (const auto& mode : modes) {
+            const auto s = passes(systems, engine.second, mode.second >= 0, mode.second);
+            cout << engine.first << " " << mode.first << " " << systems.size() / (s.medianNs / 1e9) << " "
+                 << s.medianNs / 1e6 << " " << s.p95Ns / 1e6 << " " << s.p99Ns / 1e6 << endl;
+        }
+    return 0;
+}
@@ -1,6 +1,6 @@
 #pragma once
 
-#include <wmmintrin.h>
+#include <emmintrin.h>
 
 class AESKey {
     using byte = unsigned char;
@@ -29,7 +29,7 @@ class AES {
 
         static AES& instance();
 
-        void AESEncrypt(byte ciphertext[], const byte plaintext[], const AESKey key, const int round);
-        void AESDecrypt(byte plaintext[], const byte ciphertext[], const AESKey key, const int round);
+        void AESEncrypt(byte ciphertext[], const byte plaintext[], const AESKey& key, const int round);
+        void AESDecrypt(byte plaintext[], const byte ciphertext[], const AESKey& key, const int round);
 };
 
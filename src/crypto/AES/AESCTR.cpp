@@ -0,0 +1,98 @@
+#include "AESCTR.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+
+AESCTR::AESCTR(const byte key[16])
+{
+    AESRound::ops().expandKey(rk, key);
+}
+
+AESCTR AESCTR::fromSeed(uint64_t seed)
+{
+    byte key[16] = { 0x00 };
+    for (int i = 0; i < 8; ++i) key[i] = (seed >> (8 * i)) & 0xff;
+    return AESCTR(key);
+}
+
+uint64_t AESCTR::defaultSeed()
+{
+    const char *env = getenv("WEM_SEED");
+    if (env && *env) {
+        // strtoull would take "-1" and stop quietly at garbage
+        char *end;
+        errno = 0;
+        const uint64_t seed = strtoull(env, &end, 10);
+        if (*end || errno || !isdigit(static_cast<unsigned char>(*env))) {
+            std::cerr << "WEM_SEED=" << env << " is not a seed (a decimal 64-bit number)" << std::endl;
+            std::exit(1);
+        }
+        return seed;
+    }
+    std::random_device rd;
+    return (static_cast<uint64_t>(rd()) << 32) | rd();
+}
+
+void AESCTR::generate(byte out[bufferSize])
+{
+    constexpr int lanes = AESRound::batchLanes;
+    const auto& ops = AESRound::ops();
+
+    __m128i m[lanes];
+    for (int j = 0; j < lanes; ++j, ++counter)
+        m[j] = _mm_xor_si128(_mm_set_epi64x(static_cast<long long>(__builtin_bswap64(counter)), 0), rk[0]);
+    ops.encRoundsBatch(m, lanes, rk + 1, 9);
+    for (int j = 0; j < lanes; ++j)
+        _mm_storeu_si128((__m128i *)(out + 16 * j), ops.encLast(m[j], rk[10]));
+    return;
+}
+
+void AESCTR::fill(byte out[], size_t len)
+{
+    while (len > 0) {
+        if (pos == bufferSize) {
+            for (; len >= bufferSize; out += bufferSize, len -= bufferSize)
+                generate(out);
+            if (len == 0) break;
+            generate(buffer);
+            pos = 0;
+        }
+        const size_t n = std::min(len, static_cast<size_t>(bufferSize - pos));
+        memcpy(out, buffer + pos, n);
+        pos += static_cast<int>(n);
+        out += n;
+        len -= n;
+    }
+    return;
+}
+
+unsigned char AESCTR::next8()
+{
+    byte x;
+    fill(&x, 1);
+    return x;
+}
+
+uint32_t AESCTR::next32()
+{
+    uint32_t x;
+    fill(reinterpret_cast<byte*>(&x), 4);
+    return x;
+}
+
+uint32_t AESCTR::bounded(uint32_t range)
+{
+    uint64_t m = static_cast<uint64_t>(next32()) * range;
+    if (static_cast<uint32_t>(m) < range) {
+        // 2^32 mod range low products are over-represented
+        const uint32_t threshold = -range % range;
+        while (static_cast<uint32_t>(m) < threshold)
+            m = static_cast<uint64_t>(next32()) * range;
+    }
+    return static_cast<uint32_t>(m >> 32);
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "AESRound.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <emmintrin.h>
+
+// AES-128 in counter mode as a byte stream: block i encrypts i as a 64-bit
+// big-endian integer in bytes 8..15 (bytes 0..7 zero). The buffer is
+// refilled lazily, AESRound::batchLanes blocks at a time through the batched
+// rounds, so their AES latency overlaps; large fills skip the buffer.
+//
+// It is also the drivers' seeded PRNG: fromSeed(defaultSeed()) gives a
+// stream that WEM_SEED=<seed> reproduces.
+class AESCTR {
+    using byte = unsigned char;
+
+    private:
+        static constexpr int bufferSize = 16 * AESRound::batchLanes;
+
+        __m128i rk[11];
+        uint64_t counter = 0;
+        alignas(16) byte buffer[bufferSize];
+        int pos = bufferSize;
+
+        void generate(byte out[bufferSize]);
+
+    public:
+        explicit AESCTR(const byte key[16]);
+        // the seed, little-endian, as the key
+        static AESCTR fromSeed(uint64_t seed);
+
+        // WEM_SEED from the environment (exits on a malformed value), else a fresh
+        // std::random_device seed
+        static uint64_t defaultSeed();
+
+        // the next len bytes of the stream
+        void fill(byte out[], size_t len);
+        byte next8();
+        uint32_t next32();
+
+        // uniform in [0, range) for range > 0: Lemire's multiply-shift, with
+        // the rare biased draws rejected
+        uint32_t bounded(uint32_t range);
+
+        // Fisher-Yates on a[0, n)
+        template <typename T>
+        void shuffle(T a[], int n)
+        {
+            for (int i = n - 1; i > 0; --i) {
+                const int j = static_cast<int>(bounded(static_cast<uint32_t>(i + 1)));
+                const T tmp = a[i];
+                a[i] = a[j];
+                a[j] = tmp;
+            }
+            return;
+        }
+};
@@ -0,0 +1,290 @@
+#include "AESRound.h"
+#include "../GF/GF28.h"
+#include "../utils/cpu.h"
+
+#include <array>
+#include <cstring>
+#include <immintrin.h>
+
+/****************************    AES-NI     ****************************************/
+#define AES_128_key_exp(k, rcon) aes_128_key_expansion(k, _mm_aeskeygenassist_si128(k, rcon))
+__attribute__((target("aes")))
+static inline __m128i aes_128_key_expansion(__m128i key, __m128i keygened)
+{
+    keygened = _mm_shuffle_epi32(keygened, _MM_SHUFFLE(3,3,3,3));
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    return _mm_xor_si128(key, keygened);
+}
+
+__attribute__((target("aes")))
+static void expandKeyNI(__m128i rk[11], const unsigned char key[16])
+{
+    rk[0] = _mm_loadu_si128((const __m128i*)key);
+    rk[1]  = AES_128_key_exp(rk[0], 0x01);
+    rk[2]  = AES_128_key_exp(rk[1], 0x02);
+    rk[3]  = AES_128_key_exp(rk[2], 0x04);
+    rk[4]  = AES_128_key_exp(rk[3], 0x08);
+    rk[5]  = AES_128_key_exp(rk[4], 0x10);
+    rk[6]  = AES_128_key_exp(rk[5], 0x20);
+    rk[7]  = AES_128_key_exp(rk[6], 0x40);
+    rk[8]  = AES_128_key_exp(rk[7], 0x80);
+    rk[9]  = AES_128_key_exp(rk[8], 0x1B);
+    rk[10] = AES_128_key_exp(rk[9], 0x36);
+    return;
+}
+
+__attribute__((target("aes")))
+static __m128i invMixColumnsNI(__m128i k)
+{
+    return _mm_aesimc_si128(k);
+}
+
+__attribute__((target("aes")))
+static __m128i encRoundsNI(__m128i m, const __m128i rk[], int n)
+{
+    for (int i = 0; i < n; ++i)
+        m = _mm_aesenc_si128(m, rk[i]);
+    return m;
+}
+
+__attribute__((target("aes")))
+static __m128i encLastNI(__m128i m, __m128i k)
+{
+    return _mm_aesenclast_si128(m, k);
+}
+
+__attribute__((target("aes")))
+static __m128i decRoundsNI(__m128i m, const __m128i rk[], int n)
+{
+    for (int i = 0; i < n; ++i)
+        m = _mm_aesdec_si128(m, rk[i]);
+    return m;
+}
+
+__attribute__((target("aes")))
+static __m128i decLastNI(__m128i m, __m128i k)
+{
+    return _mm_aesdeclast_si128(m, k);
+}
+
+// lanes blocks in registers, round by round; the remainder one at a time
+template <bool encrypt>
+__attribute__((target("aes")))
+static void roundsBatchNI(__m128i m[], int count, const __m128i rk[], int n)
+{
+    constexpr int lanes = AESRound::batchLanes;
+    int b = 0;
+    for (; b + lanes <= count; b += lanes) {
+        __m128i x[lanes];
+        for (int j = 0; j < lanes; ++j) x[j] = m[b + j];
+        for (int i = 0; i < n; ++i)
+            for (int j = 0; j < lanes; ++j)
+                x[j] = encrypt ? _mm_aesenc_si128(x[j], rk[i]) : _mm_aesdec_si128(x[j], rk[i]);
+        for (int j = 0; j < lanes; ++j) m[b + j] = x[j];
+    }
+    for (; b < count; ++b)
+        m[b] = encrypt ? encRoundsNI(m[b], rk, n) : decRoundsNI(m[b], rk, n);
+    return;
+}
+
+// two blocks per 256-bit lane pair, so a group of batchLanes blocks is half as many instructions
+template <bool encrypt>
+__attribute__((target("avx2,aes,vaes")))
+static void roundsBatchVAES(__m128i m[], int count, const __m128i rk[], int n)
+{
+    constexpr int lanes = AESRound::batchLanes / 2;
+    int b = 0;
+    for (; b + 2 * lanes <= count; b += 2 * lanes) {
+        __m256i x[lanes];
+        for (int j = 0; j < lanes; ++j) x[j] = _mm256_loadu_si256((const __m256i *)(m + b + 2 * j));
+        for (int i = 0; i < n; ++i) {
+            const auto k = _mm256_broadcastsi128_si256(rk[i]);
+            for (int j = 0; j < lanes; ++j)
+                x[j] = encrypt ? _mm256_aesenc_epi128(x[j], k) : _mm256_aesdec_epi128(x[j], k);
+        }
+        for (int j = 0; j < lanes; ++j) _mm256_storeu_si256((__m256i *)(m + b + 2 * j), x[j]);
+    }
+    roundsBatchNI<encrypt>(m + b, count - b, rk, n);
+    return;
+}
+
+/****************************    portable     ****************************************/
+constexpr auto _ct_genSbox()
+{
+    std::array<unsigned char, 256> sbox = { 0x00 };
+    for (int x = 0; x < 256; ++x) {
+        const unsigned char inv = GF28::inv(x);
+
+        unsigned char s = inv;
+        for (int r = 1; r <= 4; ++r)
+            s ^= static_cast<unsigned char>((inv << r) | (inv >> (8 - r)));
+        sbox[x] = s ^ 0x63;
+    }
+    return sbox;
+}
+constexpr auto softSbox = _ct_genSbox();
+
+constexpr auto _ct_genInvSbox()
+{
+    std::array<unsigned char, 256> invsbox = { 0x00 };
+    for (int x = 0; x < 256; ++x)
+        invsbox[softSbox[x]] = x;
+    return invsbox;
+}
+constexpr auto softInvSbox = _ct_genInvSbox();
+
+using State = unsigned char[16];
+
+static inline void toBytes(State s, __m128i m)
+{
+    _mm_storeu_si128((__m128i *)s, m);
+    return;
+}
+
+static inline __m128i fromBytes(const State s)
+{
+    return _mm_loadu_si128((const __m128i *)s);
+}
+
+// state byte 4 * c + r holds row r, column c
+static inline void subShift(State out, const State in)
+{
+    for (int c = 0; c < 4; ++c)
+        for (int r = 0; r < 4; ++r)
+            out[4 * c + r] = softSbox[in[4 * ((c + r) & 3) + r]];
+    return;
+}
+
+static inline void invSubShift(State out, const State in)
+{
+    for (int c = 0; c < 4; ++c)
+        for (int r = 0; r < 4; ++r)
+            out[4 * c + r] = softInvSbox[in[4 * ((c - r + 4) & 3) + r]];
+    return;
+}
+
+static inline void mixColumns(State s)
+{
+    for (int c = 0; c < 4; ++c) {
+        const unsigned char a0 = s[4 * c + 0], a1 = s[4 * c + 1], a2 = s[4 * c + 2], a3 = s[4 * c + 3];
+        const unsigned char t = a0 ^ a1 ^ a2 ^ a3;
+        s[4 * c + 0] = a0 ^ t ^ GF28::xtime(a0 ^ a1);
+        s[4 * c + 1] = a1 ^ t ^ GF28::xtime(a1 ^ a2);
+        s[4 * c + 2] = a2 ^ t ^ GF28::xtime(a2 ^ a3);
+        s[4 * c + 3] = a3 ^ t ^ GF28::xtime(a3 ^ a0);
+    }
+    return;
+}
+
+static inline void invMixColumns(State s)
+{
+    for (int c = 0; c < 4; ++c) {
+        const unsigned char a0 = s[4 * c + 0], a1 = s[4 * c + 1], a2 = s[4 * c + 2], a3 = s[4 * c + 3];
+        s[4 * c + 0] = GF28::mul(a0, 0x0e) ^ GF28::mul(a1, 0x0b) ^ GF28::mul(a2, 0x0d) ^ GF28::mul(a3, 0x09);
+        s[4 * c + 1] = GF28::mul(a0, 0x09) ^ GF28::mul(a1, 0x0e) ^ GF28::mul(a2, 0x0b) ^ GF28::mul(a3, 0x0d);
+        s[4 * c + 2] = GF28::mul(a0, 0x0d) ^ GF28::mul(a1, 0x09) ^ GF28::mul(a2, 0x0e) ^ GF28::mul(a3, 0x0b);
+        s[4 * c + 3] = GF28::mul(a0, 0x0b) ^ GF28::mul(a1, 0x0d) ^ GF28::mul(a2, 0x09) ^ GF28::mul(a3, 0x0e);
+    }
+    return;
+}
+
+static void expandKeySoft(__m128i rk[11], const unsigned char key[16])
+{
+    static const unsigned char rcon[11] = { 0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1b, 0x36 };
+
+    unsigned char w[11 * 16];
+    memcpy(w, key, 16);
+    for (int i = 4; i < 44; ++i) {
+        unsigned char t[4];
+        memcpy(t, w + 4 * (i - 1), 4);
+        if (i % 4 == 0) {
+            const unsigned char t0 = t[0];
+            t[0] = softSbox[t[1]] ^ rcon[i / 4];
+            t[1] = softSbox[t[2]];
+            t[2] = softSbox[t[3]];
+            t[3] = softSbox[t0];
+        }
+        for (int b = 0; b < 4; ++b)
+            w[4 * i + b] = w[4 * (i - 4) + b] ^ t[b];
+    }
+
+    for (int r = 0; r < 11; ++r)
+        rk[r] = fromBytes(w + 16 * r);
+    return;
+}
+
+static __m128i invMixColumnsSoft(__m128i k)
+{
+    State s;
+    toBytes(s, k);
+    invMixColumns(s);
+    return fromBytes(s);
+}
+
+static __m128i encRoundsSoft(__m128i m, const __m128i rk[], int n)
+{
+    State s, t;
+    toBytes(s, m);
+    for (int i = 0; i < n; ++i) {
+        subShift(t, s);
+        mixColumns(t);
+        toBytes(s, _mm_xor_si128(fromBytes(t), rk[i]));
+    }
+    return fromBytes(s);
+}
+
+static __m128i encLastSoft(__m128i m, __m128i k)
+{
+    State s, t;
+    toBytes(s, m);
+    subShift(t, s);
+    return _mm_xor_si128(fromBytes(t), k);
+}
+
+static __m128i decRoundsSoft(__m128i m, const __m128i rk[], int n)
+{
+    State s, t;
+    toBytes(s, m);
+    for (int i = 0; i < n; ++i) {
+        invSubShift(t, s);
+        invMixColumns(t);
+        toBytes(s, _mm_xor_si128(fromBytes(t), rk[i]));
+    }
+    return fromBytes(s);
+}
+
+static __m128i decLastSoft(__m128i m, __m128i k)
+{
+    State s, t;
+    toBytes(s, m);
+    invSubShift(t, s);
+    return _mm_xor_si128(fromBytes(t), k);
+}
+
+template <bool encrypt>
+static void roundsBatchSoft(__m128i m[], int count, const __m128i rk[], int n)
+{
+    for (int b = 0; b < count; ++b)
+        m[b] = encrypt ? encRoundsSoft(m[b], rk, n) : decRoundsSoft(m[b], rk, n);
+    return;
+}
+
+static AESRound::Ops bindOps()
+{
+    if (cpu::hasVAES())
+        return { expandKeyNI, invMixColumnsNI, encRoundsNI, encLastNI, decRoundsNI, decLastNI,
+                 roundsBatchVAES<true>, roundsBatchVAES<false> };
+    if (cpu::hasAESNI())
+        return { expandKeyNI, invMixColumnsNI, encRoundsNI, encLastNI, decRoundsNI, decLastNI,
+                 roundsBatchNI<true>, roundsBatchNI<false> };
+    return { expandKeySoft, invMixColumnsSoft, encRoundsSoft, encLastSoft, decRoundsSoft, decLastSoft,
+             roundsBatchSoft<true>, roundsBatchSoft<false> };
+}
+
+const AESRound::Ops& AESRound::ops()
+{
+    static const Ops o = bindOps();
+    return o;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <emmintrin.h>
+
+// AES round primitives, bound once at startup to AES-NI when present or to
+// a portable table implementation otherwise (see utils/cpu.h)
+namespace AESRound {
+    struct Ops {
+        // rk[0..10] = AES-128 key expansion of key
+        void (*expandKey)(__m128i rk[11], const unsigned char key[16]);
+
+        // InvMixColumns, to derive the equivalent inverse cipher round keys
+        __m128i (*invMixColumns)(__m128i k);
+
+        // m = aesenc(m, rk[i]) for i in [0, n)
+        __m128i (*encRounds)(__m128i m, const __m128i rk[], int n);
+        __m128i (*encLast)(__m128i m, __m128i k);
+
+        // m = aesdec(m, rk[i]) for i in [0, n)
+        __m128i (*decRounds)(__m128i m, const __m128i rk[], int n);
+        __m128i (*decLast)(__m128i m, __m128i k);
+
+        // the same rounds on m[0, count), several independent blocks per
+        // round so the aesenc / aesdec latency overlaps
+        void (*encRoundsBatch)(__m128i m[], int count, const __m128i rk[], int n);
+        void (*decRoundsBatch)(__m128i m[], int count, const __m128i rk[], int n);
+    };
+
+    // blocks interleaved per call of the batch kernels
+    constexpr int batchLanes = 8;
+
+    const Ops& ops();
+}
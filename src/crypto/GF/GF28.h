@@ -1,13 +1,100 @@
 #pragma once
 
+#include <array>
+
+// GF(2^8) with the AES polynomial x^8 + x^4 + x^3 + x + 1. Header-only so
+// the byte-level helpers inline into the hot loops; all tables are built
+// at compile time.
 namespace GF28 {
-    // DLog respective to 0x03
-    unsigned char log03(unsigned char a);
+    // 0x02 * a
+    constexpr unsigned char xtime(unsigned char a)
+    {
+        return static_cast<unsigned char>((a << 1) ^ (0x1b * (a >> 7)));
+    }
+
+    namespace detail {
+        using Table = std::array<unsigned char, 256>;
+        using NibbleTable = std::array<std::array<unsigned char, 16>, 256>;
+
+        // 3^e for e in [0, 510), doubled so exp[log a + log b] needs no reduction
+        constexpr auto genExpTable()
+        {
+            std::array<unsigned char, 510> table = { 0x00 };
+            unsigned char cur = 0x01;
+            for (int e = 0; e < 510; ++e) {
+                table[e] = cur;
+                cur ^= xtime(cur);
+            }
+            return table;
+        }
+
+        constexpr auto genLogTable(const std::array<unsigned char, 510>& expTable)
+        {
+            Table table = { 0x00 };
+            for (int e = 254; e >= 0; --e)
+                table[expTable[e]] = e;
+            return table;
+        }
+    }
+
+    inline constexpr auto expTable = detail::genExpTable();
+
+    // DLog respective to 0x03, log03(0) = 0
+    inline constexpr auto logTable = detail::genLogTable(expTable);
+
+    constexpr unsigned char exp03(int e) { return expTable[e]; }
+    constexpr unsigned char log03(unsigned char a) { return logTable[a]; }
+
+    // a * 3^logb, the log-domain form of a multiply by a fixed non-zero constant
+    constexpr unsigned char mulLog(unsigned char a, unsigned char logb)
+    {
+        return a ? expTable[logTable[a] + logb] : 0x00;
+    }
 
-    // inverse of a in GF(2^8)
-    unsigned char inv(unsigned char a);
+    // a * b through the log/exp tables, no 64 KB table lookup
+    constexpr unsigned char mulViaLog(unsigned char a, unsigned char b)
+    {
+        return (a && b) ? expTable[logTable[a] + logTable[b]] : 0x00;
+    }
+
+    namespace detail {
+        constexpr auto genInvTable()
+        {
+            Table table = { 0x00 };
+            for (int a = 0x01; a <= 0xff; ++a)
+                table[a] = expTable[255 - logTable[a]];
+            return table;
+        }
+
+        constexpr auto genMulTable()
+        {
+            std::array<Table, 256> table = {{ {{ 0x00 }} }};
+            for (int a = 0x01; a <= 0xff; ++a)
+                for (int b = 0x01; b <= 0xff; ++b)
+                    table[a][b] = expTable[logTable[a] + logTable[b]];
+            return table;
+        }
+
+        // c * x = lo[c][x & 0x0f] ^ hi[c][x >> 4], 16-entry rows for PSHUFB
+        constexpr auto genNibbleTable(int shift)
+        {
+            NibbleTable table = {{ {{ 0x00 }} }};
+            for (int c = 0x00; c <= 0xff; ++c)
+                for (int i = 0; i < 16; ++i)
+                    table[c][i] = mulViaLog(c, i << shift);
+            return table;
+        }
+    }
+
+    inline constexpr auto invTable = detail::genInvTable();
+    inline constexpr auto mulTable = detail::genMulTable();
+
+    alignas(64) inline constexpr auto nibbleLo = detail::genNibbleTable(0);
+    alignas(64) inline constexpr auto nibbleHi = detail::genNibbleTable(4);
+
+    // inverse of a in GF(2^8), inv(0) = 0
+    constexpr unsigned char inv(unsigned char a) { return invTable[a]; }
 
     // a * b in GF(2^8)
-    unsigned char mul(unsigned char a, unsigned char b);
+    constexpr unsigned char mul(unsigned char a, unsigned char b) { return mulTable[a][b]; }
 }
-
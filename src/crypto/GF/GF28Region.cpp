@@ -0,0 +1,265 @@
+#include "GF28Region.h"
+#include "GF28.h"
+#include "../utils/cpu.h"
+
+#include <immintrin.h>
+
+// split-nibble form: c * x = GF28::nibbleLo[c][x & 0x0f] ^ GF28::nibbleHi[c][x >> 4]
+
+/****************************    scalar     ****************************************/
+template <bool accumulate>
+static void mulScalar(unsigned char *dst, const unsigned char *src, unsigned char c, int from, int len)
+{
+    const auto lo = GF28::nibbleLo[c].data();
+    const auto hi = GF28::nibbleHi[c].data();
+    for (int i = from; i < len; ++i) {
+        const unsigned char p = lo[src[i] & 0x0f] ^ hi[src[i] >> 4];
+        dst[i] = accumulate ? dst[i] ^ p : p;
+    }
+    return;
+}
+
+template <bool accumulate>
+static void mulRegionScalar(unsigned char *dst, const unsigned char *src, unsigned char c, int len)
+{
+    mulScalar<accumulate>(dst, src, c, 0, len);
+    return;
+}
+
+static void xorRegionScalar(unsigned char *dst, const unsigned char *src, int len)
+{
+    int i = 0;
+    for (; i + 16 <= len; i += 16) {
+        const auto x = _mm_loadu_si128((const __m128i *)(src + i));
+        const auto y = _mm_loadu_si128((const __m128i *)(dst + i));
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_xor_si128(x, y));
+    }
+    for (; i < len; ++i)
+        dst[i] ^= src[i];
+    return;
+}
+
+static void xorRegionsScalar(unsigned char *dst, const unsigned char *const *srcs, int count, int len)
+{
+    int i = 0;
+    for (; i + 16 <= len; i += 16) {
+        auto x = _mm_loadu_si128((const __m128i *)(dst + i));
+        for (int s = 0; s < count; ++s)
+            x = _mm_xor_si128(x, _mm_loadu_si128((const __m128i *)(srcs[s] + i)));
+        _mm_storeu_si128((__m128i *)(dst + i), x);
+    }
+    for (; i < len; ++i)
+        for (int s = 0; s < count; ++s)
+            dst[i] ^= srcs[s][i];
+    return;
+}
+
+/****************************    SSSE3     ****************************************/
+template <bool accumulate>
+__attribute__((target("ssse3")))
+static void mulRegionSSSE3(unsigned char *dst, const unsigned char *src, unsigned char c, int len)
+{
+    const auto tlo = _mm_load_si128((const __m128i *)GF28::nibbleLo[c].data());
+    const auto thi = _mm_load_si128((const __m128i *)GF28::nibbleHi[c].data());
+    const auto mask = _mm_set1_epi8(0x0f);
+
+    int i = 0;
+    for (; i + 16 <= len; i += 16) {
+        const auto x = _mm_loadu_si128((const __m128i *)(src + i));
+        const auto l = _mm_shuffle_epi8(tlo, _mm_and_si128(x, mask));
+        const auto h = _mm_shuffle_epi8(thi, _mm_and_si128(_mm_srli_epi64(x, 4), mask));
+        auto p = _mm_xor_si128(l, h);
+        if constexpr (accumulate)
+            p = _mm_xor_si128(p, _mm_loadu_si128((const __m128i *)(dst + i)));
+        _mm_storeu_si128((__m128i *)(dst + i), p);
+    }
+    mulScalar<accumulate>(dst, src, c, i, len);
+    return;
+}
+
+/****************************    AVX2     ****************************************/
+template <bool accumulate>
+__attribute__((target("avx2")))
+static void mulRegionAVX2(unsigned char *dst, const unsigned char *src, unsigned char c, int len)
+{
+    const auto tlo = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i *)GF28::nibbleLo[c].data()));
+    const auto thi = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i *)GF28::nibbleHi[c].data()));
+    const auto mask = _mm256_set1_epi8(0x0f);
+
+    int i = 0;
+    for (; i + 32 <= len; i += 32) {
+        const auto x = _mm256_loadu_si256((const __m256i *)(src + i));
+        const auto l = _mm256_shuffle_epi8(tlo, _mm256_and_si256(x, mask));
+        const auto h = _mm256_shuffle_epi8(thi, _mm256_and_si256(_mm256_srli_epi64(x, 4), mask));
+        auto p = _mm256_xor_si256(l, h);
+        if constexpr (accumulate)
+            p = _mm256_xor_si256(p, _mm256_loadu_si256((const __m256i *)(dst + i)));
+        _mm256_storeu_si256((__m256i *)(dst + i), p);
+    }
+    mulScalar<accumulate>(dst, src, c, i, len);
+    return;
+}
+
+__attribute__((target("avx2")))
+static void xorRegionAVX2(unsigned char *dst, const unsigned char *src, int len)
+{
+    int i = 0;
+    for (; i + 32 <= len; i += 32) {
+        const auto x = _mm256_loadu_si256((const __m256i *)(src + i));
+        const auto y = _mm256_loadu_si256((const __m256i *)(dst + i));
+        _mm256_storeu_si256((__m256i *)(dst + i), _mm256_xor_si256(x, y));
+    }
+    for (; i < len; ++i)
+        dst[i] ^= src[i];
+    return;
+}
+
+__attribute__((target("avx2")))
+static void xorRegionsAVX2(unsigned char *dst, const unsigned char *const *srcs, int count, int len)
+{
+    int i = 0;
+    for (; i + 32 <= len; i += 32) {
+        auto x = _mm256_loadu_si256((const __m256i *)(dst + i));
+        for (int s = 0; s < count; ++s)
+            x = _mm256_xor_si256(x, _mm256_loadu_si256((const __m256i *)(srcs[s] + i)));
+        _mm256_storeu_si256((__m256i *)(dst + i), x);
+    }
+    for (; i < len; ++i)
+        for (int s = 0; s < count; ++s)
+            dst[i] ^= srcs[s][i];
+    return;
+}
+
+/****************************    AVX-512BW     ****************************************/
+// The maskz forms under a full mask: GCC's _mm512_broadcast_i32x4 and
+// _mm512_srli_epi64 merge into an undefined register, which -Wuninitialized
+// reports; the full mask compiles to the same instructions.
+template <bool accumulate>
+__attribute__((target("avx512f,avx512bw")))
+static void mulRegionAVX512(unsigned char *dst, const unsigned char *src, unsigned char c, int len)
+{
+    const auto tlo = _mm512_maskz_broadcast_i32x4(0xffff, _mm_load_si128((const __m128i *)GF28::nibbleLo[c].data()));
+    const auto thi = _mm512_maskz_broadcast_i32x4(0xffff, _mm_load_si128((const __m128i *)GF28::nibbleHi[c].data()));
+    const auto mask = _mm512_set1_epi8(0x0f);
+
+    int i = 0;
+    for (; i + 64 <= len; i += 64) {
+        const auto x = _mm512_loadu_si512((const void *)(src + i));
+        const auto l = _mm512_shuffle_epi8(tlo, _mm512_and_si512(x, mask));
+        const auto h = _mm512_shuffle_epi8(thi, _mm512_and_si512(_mm512_maskz_srli_epi64(0xff, x, 4), mask));
+        auto p = _mm512_xor_si512(l, h);
+        if constexpr (accumulate)
+            p = _mm512_xor_si512(p, _mm512_loadu_si512((const void *)(dst + i)));
+        _mm512_storeu_si512((void *)(dst + i), p);
+    }
+    mulScalar<accumulate>(dst, src, c, i, len);
+    return;
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static void xorRegionAVX512(unsigned char *dst, const unsigned char *src, int len)
+{
+    int i = 0;
+    for (; i + 64 <= len; i += 64) {
+        const auto x = _mm512_loadu_si512((const void *)(src + i));
+        const auto y = _mm512_loadu_si512((const void *)(dst + i));
+        _mm512_storeu_si512((void *)(dst + i), _mm512_xor_si512(x, y));
+    }
+    for (; i < len; ++i)
+        dst[i] ^= src[i];
+    return;
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static void xorRegionsAVX512(unsigned char *dst, const unsigned char *const *srcs, int count, int len)
+{
+    int i = 0;
+    for (; i + 64 <= len; i += 64) {
+        auto x = _mm512_loadu_si512((const void *)(dst + i));
+        for (int s = 0; s < count; ++s)
+            x = _mm512_xor_si512(x, _mm512_loadu_si512((const void *)(srcs[s] + i)));
+        _mm512_storeu_si512((void *)(dst + i), x);
+    }
+    for (; i < len; ++i)
+        for (int s = 0; s < count; ++s)
+            dst[i] ^= srcs[s][i];
+    return;
+}
+
+/****************************    GFNI     ****************************************/
+// GF2P8MULB reduces by x^8 + x^4 + x^3 + x + 1, the same field as GF28
+template <bool accumulate>
+__attribute__((target("avx512f,avx512bw,gfni")))
+static void mulRegionGFNI(unsigned char *dst, const unsigned char *src, unsigned char c, int len)
+{
+    const auto vc = _mm512_set1_epi8(static_cast<char>(c));
+
+    int i = 0;
+    for (; i + 64 <= len; i += 64) {
+        const auto x = _mm512_loadu_si512((const void *)(src + i));
+        auto p = _mm512_gf2p8mul_epi8(x, vc);
+        if constexpr (accumulate)
+            p = _mm512_xor_si512(p, _mm512_loadu_si512((const void *)(dst + i)));
+        _mm512_storeu_si512((void *)(dst + i), p);
+    }
+    mulScalar<accumulate>(dst, src, c, i, len);
+    return;
+}
+
+struct RegionKernels {
+    void (*mul)(unsigned char *dst, const unsigned char *src, unsigned char c, int len);
+    void (*mulAdd)(unsigned char *dst, const unsigned char *src, unsigned char c, int len);
+    void (*xorr)(unsigned char *dst, const unsigned char *src, int len);
+    void (*xorMany)(unsigned char *dst, const unsigned char *const *srcs, int count, int len);
+};
+
+static RegionKernels bindKernels()
+{
+    switch (cpu::tier()) {
+        case cpu::GFNI:
+            return { mulRegionGFNI<false>, mulRegionGFNI<true>, xorRegionAVX512, xorRegionsAVX512 };
+        case cpu::AVX512BW:
+            return { mulRegionAVX512<false>, mulRegionAVX512<true>, xorRegionAVX512, xorRegionsAVX512 };
+        case cpu::AVX2:
+            return { mulRegionAVX2<false>, mulRegionAVX2<true>, xorRegionAVX2, xorRegionsAVX2 };
+        case cpu::SSSE3:
+            return { mulRegionSSSE3<false>, mulRegionSSSE3<true>, xorRegionScalar, xorRegionsScalar };
+        default:
+            return { mulRegionScalar<false>, mulRegionScalar<true>, xorRegionScalar, xorRegionsScalar };
+    }
+}
+
+static const RegionKernels& kernels()
+{
+    static const RegionKernels k = bindKernels();
+    return k;
+}
+
+void GF28::mulRegion(unsigned char *dst, const unsigned char *src, unsigned char c, int len)
+{
+    kernels().mul(dst, src, c, len);
+    return;
+}
+
+void GF28::mulAddRegion(unsigned char *dst, const unsigned char *src, unsigned char c, int len)
+{
+    if (c == 0x00) return;
+    if (c == 0x01) {
+        kernels().xorr(dst, src, len);
+        return;
+    }
+    kernels().mulAdd(dst, src, c, len);
+    return;
+}
+
+void GF28::xorRegion(unsigned char *dst, const unsigned char *src, int len)
+{
+    kernels().xorr(dst, src, len);
+    return;
+}
+
+void GF28::xorRegions(unsigned char *dst, const unsigned char *const *srcs, int count, int len)
+{
+    kernels().xorMany(dst, srcs, count, len);
+    return;
+}
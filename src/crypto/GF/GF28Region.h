@@ -0,0 +1,15 @@
+#pragma once
+
+namespace GF28 {
+    // dst[i] = c * src[i] for i in [0, len), dst may alias src
+    void mulRegion(unsigned char *dst, const unsigned char *src, unsigned char c, int len);
+
+    // dst[i] ^= c * src[i] for i in [0, len)
+    void mulAddRegion(unsigned char *dst, const unsigned char *src, unsigned char c, int len);
+
+    // dst[i] ^= src[i] for i in [0, len)
+    void xorRegion(unsigned char *dst, const unsigned char *src, int len);
+
+    // dst[i] ^= srcs[0][i] ^ ... ^ srcs[count - 1][i] for i in [0, len), one pass over dst
+    void xorRegions(unsigned char *dst, const unsigned char *const *srcs, int count, int len);
+}
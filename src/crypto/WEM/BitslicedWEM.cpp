@@ -0,0 +1,512 @@
+#include "BitslicedWEM.h"
+#include "WEMFamily.hpp"
+#include "../AES/AESRound.h"
+#include "../utils/cpu.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <emmintrin.h>
+
+using bitslicedWEM::lanes;
+
+// one bit per block: block j is bit j % 64 of element j / 64. The kernels
+// are plain vector-extension code, compiled once for AVX2 and once for the
+// baseline (two SSE2 halves per word).
+typedef uint64_t Word __attribute__((vector_size(32)));
+
+// s[p][k] = bit k of byte p of every block
+typedef Word State[16][8];
+
+/****************************    transposition     ****************************************/
+// 16 x 16 byte transpose: four rounds of interleaving rows i and i + 8
+static inline void transpose16(__m128i x[16])
+{
+    __m128i y[16];
+    for (int round = 0; round < 4; ++round) {
+        for (int i = 0; i < 8; ++i) {
+            y[2 * i] = _mm_unpacklo_epi8(x[i], x[i + 8]);
+            y[2 * i + 1] = _mm_unpackhi_epi8(x[i], x[i + 8]);
+        }
+        for (int i = 0; i < 16; ++i) x[i] = y[i];
+    }
+    return;
+}
+
+// 16 blocks at a time: after the transpose x[p] holds byte p of each block
+static void toSlices(State s, const unsigned char *in, int n)
+{
+    for (int p = 0; p < 16; ++p)
+        for (int k = 0; k < 8; ++k) s[p][k] = Word{};
+
+    __m128i x[16];
+    for (int c = 0; c < lanes / 16; ++c) {
+        for (int j = 0; j < 16; ++j)
+            x[j] = 16 * c + j < n ? _mm_loadu_si128((const __m128i *)(in + 16 * (16 * c + j))) : _mm_setzero_si128();
+        transpose16(x);
+        for (int p = 0; p < 16; ++p)
+            // shifting each lane left by 7 - k brings bit k of every byte to its top bit
+            for (int k = 0; k < 8; ++k) {
+                const auto bits = static_cast<uint64_t>(_mm_movemask_epi8(_mm_slli_epi64(x[p], 7 - k)));
+                s[p][k][c / 4] |= bits << (16 * (c % 4));
+            }
+    }
+    return;
+}
+
+// spread[x] has byte i = bit i of x
+constexpr auto _ct_genSpread()
+{
+    std::array<uint64_t, 256> spread = { 0 };
+    for (int x = 0; x < 256; ++x)
+        for (int i = 0; i < 8; ++i)
+            spread[x] |= static_cast<uint64_t>((x >> i) & 1) << (8 * i);
+    return spread;
+}
+constexpr auto spread = _ct_genSpread();
+
+static void fromSlices(unsigned char *out, const State s, int n)
+{
+    __m128i x[16];
+    for (int c = 0; c < lanes / 16; ++c) {
+        // x[p] = byte p of the 16 blocks, 8 blocks per spread lookup
+        for (int p = 0; p < 16; ++p) {
+            uint64_t half[2] = { 0, 0 };
+            for (int k = 0; k < 8; ++k) {
+                const uint64_t bits = s[p][k][c / 4] >> (16 * (c % 4));
+                half[0] |= spread[bits & 0xff] << k;
+                half[1] |= spread[(bits >> 8) & 0xff] << k;
+            }
+            x[p] = _mm_loadu_si128((const __m128i *)half);
+        }
+        transpose16(x);
+        for (int j = 0; j < 16 && 16 * c + j < n; ++j)
+            _mm_storeu_si128((__m128i *)(out + 16 * (16 * c + j)), x[j]);
+    }
+    return;
+}
+
+/****************************    secret S-box     ****************************************/
+// The table as a circuit: for every high nibble h and output bit b, nibble
+// g of sel[h][b] holds the low nibbles 4 g + i with bit b of
+// table[16 h + 4 g + i] set, as the bits i. The circuit only depends on the
+// table, never on the data.
+struct SBoxCircuit {
+    unsigned char sel[16][8][4];
+};
+
+static SBoxCircuit compile(const unsigned char table[256])
+{
+    SBoxCircuit c;
+    for (int h = 0; h < 16; ++h)
+        for (int b = 0; b < 8; ++b)
+            for (int g = 0; g < 4; ++g) {
+                c.sel[h][b][g] = 0;
+                for (int i = 0; i < 4; ++i)
+                    c.sel[h][b][g] |= ((table[16 * h + 4 * g + i] >> b) & 1) << i;
+            }
+    return c;
+}
+
+// d[v] = (a[0..3] == v), one minterm per nibble value
+static inline void decode(Word d[16], const Word a[4])
+{
+    const Word n0 = ~a[0], n1 = ~a[1], n2 = ~a[2], n3 = ~a[3];
+    const Word d01[4] = { n0 & n1, a[0] & n1, n0 & a[1], a[0] & a[1] };
+    const Word d23[4] = { n2 & n3, a[2] & n3, n2 & a[3], a[2] & a[3] };
+    for (int i = 0; i < 4; ++i)
+        for (int j = 0; j < 4; ++j)
+            d[4 * i + j] = d23[i] & d01[j];
+    return;
+}
+
+// y_b = xor over h of hi[h] & (xor of lo[l] over l in sel[h][b]); the inner
+// sums come from four 16-entry tables of subset sums of 4 minterms each
+static inline void secretSubBytes(Word x[8], const SBoxCircuit& c)
+{
+    Word lo[16], hi[16];
+    decode(lo, x);
+    decode(hi, x + 4);
+
+    Word sums[4][16];
+    for (int g = 0; g < 4; ++g) {
+        sums[g][0] = Word{};
+        for (int t = 1; t < 16; ++t)
+            sums[g][t] = sums[g][t & (t - 1)] ^ lo[4 * g + __builtin_ctz(t)];
+    }
+
+    Word y[8] = {};
+    for (int h = 0; h < 16; ++h)
+        for (int b = 0; b < 8; ++b) {
+            const unsigned char *v = c.sel[h][b];
+            y[b] ^= hi[h] & (sums[0][v[0]] ^ sums[1][v[1]] ^ sums[2][v[2]] ^ sums[3][v[3]]);
+        }
+
+    for (int b = 0; b < 8; ++b) x[b] = y[b];
+    return;
+}
+
+static inline void secretLayer(State s, const SBoxCircuit& c)
+{
+    for (int p = 0; p < 16; ++p) secretSubBytes(s[p], c);
+    return;
+}
+
+/****************************    AES S-box     ****************************************/
+// Boyar-Peralta: 32 and, 83 xor / xnor; q[0] is the least significant bit
+static inline void aesSubBytes(Word q[8])
+{
+    const Word x0 = q[7], x1 = q[6], x2 = q[5], x3 = q[4];
+    const Word x4 = q[3], x5 = q[2], x6 = q[1], x7 = q[0];
+
+    // top linear transformation
+    const Word y14 = x3 ^ x5;
+    const Word y13 = x0 ^ x6;
+    const Word y9 = x0 ^ x3;
+    const Word y8 = x0 ^ x5;
+    const Word t0 = x1 ^ x2;
+    const Word y1 = t0 ^ x7;
+    const Word y4 = y1 ^ x3;
+    const Word y12 = y13 ^ y14;
+    const Word y2 = y1 ^ x0;
+    const Word y5 = y1 ^ x6;
+    const Word y3 = y5 ^ y8;
+    const Word t1 = x4 ^ y12;
+    const Word y15 = t1 ^ x5;
+    const Word y20 = t1 ^ x1;
+    const Word y6 = y15 ^ x7;
+    const Word y10 = y15 ^ t0;
+    const Word y11 = y20 ^ y9;
+    const Word y7 = x7 ^ y11;
+    const Word y17 = y10 ^ y11;
+    const Word y19 = y10 ^ y8;
+    const Word y16 = t0 ^ y11;
+    const Word y21 = y13 ^ y16;
+    const Word y18 = x0 ^ y16;
+
+    // shared non-linear middle
+    const Word t2 = y12 & y15;
+    const Word t3 = y3 & y6;
+    const Word t4 = t3 ^ t2;
+    const Word t5 = y4 & x7;
+    const Word t6 = t5 ^ t2;
+    const Word t7 = y13 & y16;
+    const Word t8 = y5 & y1;
+    const Word t9 = t8 ^ t7;
+    const Word t10 = y2 & y7;
+    const Word t11 = t10 ^ t7;
+    const Word t12 = y9 & y11;
+    const Word t13 = y14 & y17;
+    const Word t14 = t13 ^ t12;
+    const Word t15 = y8 & y10;
+    const Word t16 = t15 ^ t12;
+    const Word t17 = t4 ^ t14;
+    const Word t18 = t6 ^ t16;
+    const Word t19 = t9 ^ t14;
+    const Word t20 = t11 ^ t16;
+    const Word t21 = t17 ^ y20;
+    const Word t22 = t18 ^ y19;
+    const Word t23 = t19 ^ y21;
+    const Word t24 = t20 ^ y18;
+
+    const Word t25 = t21 ^ t22;
+    const Word t26 = t21 & t23;
+    const Word t27 = t24 ^ t26;
+    const Word t28 = t25 & t27;
+    const Word t29 = t28 ^ t22;
+    const Word t30 = t23 ^ t24;
+    const Word t31 = t22 ^ t26;
+    const Word t32 = t31 & t30;
+    const Word t33 = t32 ^ t24;
+    const Word t34 = t23 ^ t33;
+    const Word t35 = t27 ^ t33;
+    const Word t36 = t24 & t35;
+    const Word t37 = t36 ^ t34;
+    const Word t38 = t27 ^ t36;
+    const Word t39 = t29 & t38;
+    const Word t40 = t25 ^ t39;
+
+    const Word t41 = t40 ^ t37;
+    const Word t42 = t29 ^ t33;
+    const Word t43 = t29 ^ t40;
+    const Word t44 = t33 ^ t37;
+    const Word t45 = t42 ^ t41;
+    const Word z0 = t44 & y15;
+    const Word z1 = t37 & y6;
+    const Word z2 = t33 & x7;
+    const Word z3 = t43 & y16;
+    const Word z4 = t40 & y1;
+    const Word z5 = t29 & y7;
+    const Word z6 = t42 & y11;
+    const Word z7 = t45 & y17;
+    const Word z8 = t41 & y10;
+    const Word z9 = t44 & y12;
+    const Word z10 = t37 & y3;
+    const Word z11 = t33 & y4;
+    const Word z12 = t43 & y13;
+    const Word z13 = t40 & y5;
+    const Word z14 = t29 & y2;
+    const Word z15 = t42 & y9;
+    const Word z16 = t45 & y14;
+    const Word z17 = t41 & y8;
+
+    // bottom linear transformation
+    const Word t46 = z15 ^ z16;
+    const Word t47 = z10 ^ z11;
+    const Word t48 = z5 ^ z13;
+    const Word t49 = z9 ^ z10;
+    const Word t50 = z2 ^ z12;
+    const Word t51 = z2 ^ z5;
+    const Word t52 = z7 ^ z8;
+    const Word t53 = z0 ^ z3;
+    const Word t54 = z6 ^ z7;
+    const Word t55 = z16 ^ z17;
+    const Word t56 = z12 ^ t48;
+    const Word t57 = t50 ^ t53;
+    const Word t58 = z4 ^ t46;
+    const Word t59 = z3 ^ t54;
+    const Word t60 = t46 ^ t57;
+    const Word t61 = z14 ^ t57;
+    const Word t62 = t52 ^ t58;
+    const Word t63 = t49 ^ t58;
+    const Word t64 = z4 ^ t59;
+    const Word t65 = t61 ^ t62;
+    const Word t66 = z1 ^ t63;
+    const Word s0 = t59 ^ t63;
+    const Word s6 = t56 ^ ~t62;
+    const Word s7 = t48 ^ ~t60;
+    const Word t67 = t64 ^ t65;
+    const Word s3 = t53 ^ t66;
+    const Word s4 = t51 ^ t66;
+    const Word s5 = t47 ^ t65;
+    const Word s1 = t64 ^ ~s3;
+    const Word s2 = t55 ^ ~t67;
+
+    q[7] = s0; q[6] = s1; q[5] = s2; q[4] = s3;
+    q[3] = s4; q[2] = s5; q[1] = s6; q[0] = s7;
+    return;
+}
+
+// the inverse of the S-box affine map: y_i = x_{i+2} ^ x_{i+5} ^ x_{i+7} ^ 0x05_i
+static inline void invAffine(Word q[8])
+{
+    Word y[8];
+    for (int i = 0; i < 8; ++i) y[i] = q[(i + 2) % 8] ^ q[(i + 5) % 8] ^ q[(i + 7) % 8];
+    y[0] = ~y[0];
+    y[2] = ~y[2];
+    for (int i = 0; i < 8; ++i) q[i] = y[i];
+    return;
+}
+
+// S = A o inv, so S^-1 = inv o A^-1 = A^-1 o S o A^-1
+static inline void aesInvSubBytes(Word q[8])
+{
+    invAffine(q);
+    aesSubBytes(q);
+    invAffine(q);
+    return;
+}
+
+/****************************    AES rounds     ****************************************/
+// byte 4 c + r of the state is row r of column c
+static inline void shiftRows(State s)
+{
+    State t;
+    memcpy(t, s, sizeof(State));
+    for (int c = 0; c < 4; ++c)
+        for (int r = 1; r < 4; ++r)
+            memcpy(s[4 * c + r], t[4 * ((c + r) & 3) + r], sizeof(s[0]));
+    return;
+}
+
+static inline void invShiftRows(State s)
+{
+    State t;
+    memcpy(t, s, sizeof(State));
+    for (int c = 0; c < 4; ++c)
+        for (int r = 1; r < 4; ++r)
+            memcpy(s[4 * ((c + r) & 3) + r], t[4 * c + r], sizeof(s[0]));
+    return;
+}
+
+// y = 0x02 * x
+static inline void xtime(Word y[8], const Word x[8])
+{
+    y[0] = x[7];
+    y[1] = x[0] ^ x[7];
+    y[2] = x[1];
+    y[3] = x[2] ^ x[7];
+    y[4] = x[3] ^ x[7];
+    y[5] = x[4];
+    y[6] = x[5];
+    y[7] = x[6];
+    return;
+}
+
+// a_r += a0 + a1 + a2 + a3 + 0x02 * (a_r + a_r+1)
+static inline void mixColumns(State s)
+{
+    for (int c = 0; c < 4; ++c) {
+        Word *a[4] = { s[4 * c], s[4 * c + 1], s[4 * c + 2], s[4 * c + 3] };
+        Word t[8], u[4][8], x[8];
+        for (int k = 0; k < 8; ++k) t[k] = a[0][k] ^ a[1][k] ^ a[2][k] ^ a[3][k];
+        for (int r = 0; r < 4; ++r) {
+            for (int k = 0; k < 8; ++k) x[k] = a[r][k] ^ a[(r + 1) & 3][k];
+            xtime(u[r], x);
+        }
+        for (int r = 0; r < 4; ++r)
+            for (int k = 0; k < 8; ++k) a[r][k] ^= t[k] ^ u[r][k];
+    }
+    return;
+}
+
+// InvMixColumns = MixColumns after adding 0x04 * (a0 + a2) to rows 0, 2 and
+// 0x04 * (a1 + a3) to rows 1, 3
+static inline void invMixColumns(State s)
+{
+    for (int c = 0; c < 4; ++c) {
+        Word *a[4] = { s[4 * c], s[4 * c + 1], s[4 * c + 2], s[4 * c + 3] };
+        for (int r = 0; r < 2; ++r) {
+            Word x[8], y[8], u[8];
+            for (int k = 0; k < 8; ++k) x[k] = a[r][k] ^ a[r + 2][k];
+            xtime(y, x);
+            xtime(u, y);
+            for (int k = 0; k < 8; ++k) {
+                a[r][k] ^= u[k];
+                a[r + 2][k] ^= u[k];
+            }
+        }
+    }
+    mixColumns(s);
+    return;
+}
+
+// the keys are public constants, so branching on their bits is still constant time
+static inline void addRoundKey(State s, __m128i key)
+{
+    unsigned char rk[16];
+    _mm_storeu_si128((__m128i *)rk, key);
+    for (int p = 0; p < 16; ++p)
+        for (int k = 0; k < 8; ++k)
+            if ((rk[p] >> k) & 1) s[p][k] = ~s[p][k];
+    return;
+}
+
+/****************************    P-layer     ****************************************/
+// rk is a P-layer schedule of PLayerKeys (WEMFamily.hpp): rk[0] whitening,
+// then rounds full AES rounds (as aesenc)
+static inline void pLayer(State s, const __m128i rk[], int rounds)
+{
+    addRoundKey(s, rk[0]);
+    for (int i = 1; i <= rounds; ++i) {
+        shiftRows(s);
+        for (int p = 0; p < 16; ++p) aesSubBytes(s[p]);
+        mixColumns(s);
+        addRoundKey(s, rk[i]);
+    }
+    return;
+}
+
+static inline void invPLayer(State s, const __m128i rk[], int rounds)
+{
+    for (int i = rounds; i >= 1; --i) {
+        addRoundKey(s, rk[i]);
+        invMixColumns(s);
+        invShiftRows(s);
+        for (int p = 0; p < 16; ++p) aesInvSubBytes(s[p]);
+    }
+    addRoundKey(s, rk[0]);
+    return;
+}
+
+/****************************    cipher     ****************************************/
+static inline void encryptSliced(State s, const SBoxCircuit& sbox, int p1, int p2)
+{
+    const auto& keys = PLayerKeys::instance();
+    secretLayer(s, sbox);
+    pLayer(s, keys.rk[0], p1);
+    secretLayer(s, sbox);
+    pLayer(s, keys.rk[1], p2);
+    secretLayer(s, sbox);
+    return;
+}
+
+static inline void decryptSliced(State s, const SBoxCircuit& invsbox, int p1, int p2)
+{
+    const auto& keys = PLayerKeys::instance();
+    secretLayer(s, invsbox);
+    invPLayer(s, keys.rk[1], p2);
+    secretLayer(s, invsbox);
+    invPLayer(s, keys.rk[0], p1);
+    secretLayer(s, invsbox);
+    return;
+}
+
+// flatten inlines the whole cipher, so every word operation is compiled for
+// the target of the entry point
+__attribute__((target("avx2"), flatten))
+static void encryptAVX2(State s, const SBoxCircuit& sbox, int p1, int p2)
+{
+    encryptSliced(s, sbox, p1, p2);
+    return;
+}
+
+__attribute__((target("avx2"), flatten))
+static void decryptAVX2(State s, const SBoxCircuit& invsbox, int p1, int p2)
+{
+    decryptSliced(s, invsbox, p1, p2);
+    return;
+}
+
+__attribute__((flatten))
+static void encryptSSE2(State s, const SBoxCircuit& sbox, int p1, int p2)
+{
+    encryptSliced(s, sbox, p1, p2);
+    return;
+}
+
+__attribute__((flatten))
+static void decryptSSE2(State s, const SBoxCircuit& invsbox, int p1, int p2)
+{
+    decryptSliced(s, invsbox, p1, p2);
+    return;
+}
+
+struct SlicedKernels {
+    void (*encrypt)(State s, const SBoxCircuit& sbox, int p1, int p2);
+    void (*decrypt)(State s, const SBoxCircuit& invsbox, int p1, int p2);
+};
+
+static const SlicedKernels& kernels()
+{
+    static const SlicedKernels k = cpu::tier() >= cpu::AVX2 ? SlicedKernels{ encryptAVX2, decryptAVX2 }
+                                                            : SlicedKernels{ encryptSSE2, decryptSSE2 };
+    return k;
+}
+
+void bitslicedWEM::encrypt(unsigned char ciphertext[], const unsigned char plaintext[], int n, const unsigned char sbox[256], int p1, int p2)
+{
+    const auto circuit = compile(sbox);
+    State s;
+    for (int b = 0; b < n; b += lanes) {
+        const int count = std::min(lanes, n - b);
+        toSlices(s, plaintext + 16 * b, count);
+        kernels().encrypt(s, circuit, p1, p2);
+        fromSlices(ciphertext + 16 * b, s, count);
+    }
+    return;
+}
+
+void bitslicedWEM::decrypt(unsigned char plaintext[], const unsigned char ciphertext[], int n, const unsigned char invsbox[256], int p1, int p2)
+{
+    const auto circuit = compile(invsbox);
+    State s;
+    for (int b = 0; b < n; b += lanes) {
+        const int count = std::min(lanes, n - b);
+        toSlices(s, ciphertext + 16 * b, count);
+        kernels().decrypt(s, circuit, p1, p2);
+        fromSlices(plaintext + 16 * b, s, count);
+    }
+    return;
+}
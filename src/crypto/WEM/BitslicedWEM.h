@@ -0,0 +1,15 @@
+#pragma once
+
+// Bitsliced WEM core: lanes blocks at a time, each block one bit position of
+// every state word, so the whole cipher is a fixed sequence of and / xor /
+// not on words, independent of the data (constant time). The secret S-box is
+// compiled per call into a decoder circuit, the P-layer AES S-box is the
+// Boyar-Peralta circuit. Words are 256 bits, AVX2 when present (utils/cpu.h).
+namespace bitslicedWEM {
+    // blocks per bitsliced batch; a shorter tail is padded
+    constexpr int lanes = 256;
+
+    // n consecutive 16-byte blocks, p1 / p2 P-layer rounds (at most 10)
+    void encrypt(unsigned char ciphertext[], const unsigned char plaintext[], int n, const unsigned char sbox[256], int p1, int p2);
+    void decrypt(unsigned char plaintext[], const unsigned char ciphertext[], int n, const unsigned char invsbox[256], int p1, int p2);
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "WEM_2EM.hpp"
+#include "BitslicedWEM.h"
+
+// The WEM<P1, P2> cipher on the bitsliced core (see BitslicedWEM.h): the
+// same results block for block, bitslicedWEM::lanes blocks per pass and
+// constant time. Meant for bulk queries; a single block still costs a pass.
+template <int P1 = 5, int P2 = 5>
+class BitslicedWEM {
+    using byte = unsigned char;
+
+    static_assert(P1 <= 10 && P2 <= 10, "the P-layer key schedule has 10 rounds");
+
+    public:
+        BitslicedWEM() = default;
+        ~BitslicedWEM() = default;
+        BitslicedWEM(const BitslicedWEM&) = delete;
+        BitslicedWEM& operator=(const BitslicedWEM&) = delete;
+
+        static BitslicedWEM& instance()
+        {
+            static BitslicedWEM BITSLICEDINSTANCE;
+            return BITSLICEDINSTANCE;
+        }
+
+        void WEMEncrypt(byte ciphertext[], const byte plaintext[], const WEMKey& key)
+        {
+            WEMEncryptBatch(ciphertext, plaintext, 1, key);
+            return;
+        }
+
+        void WEMDecrypt(byte plaintext[], const byte ciphertext[], const WEMKey& key)
+        {
+            WEMDecryptBatch(plaintext, ciphertext, 1, key);
+            return;
+        }
+
+        void WEMEncryptBatch(byte ciphertext[], const byte plaintext[], int n, const WEMKey& key)
+        {
+            bitslicedWEM::encrypt(ciphertext, plaintext, n, key.sbox[0], P1, P2);
+            return;
+        }
+
+        void WEMDecryptBatch(byte plaintext[], const byte ciphertext[], int n, const WEMKey& key)
+        {
+            bitslicedWEM::decrypt(plaintext, ciphertext, n, key.invsbox[0], P1, P2);
+            return;
+        }
+};
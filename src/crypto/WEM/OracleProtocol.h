@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+// Wire format between RemoteOracle and the oracle server (oracled) on a Unix
+// domain stream socket, in host byte order. A message is a Header and its
+// payload; the reply repeats op and count, or carries op Error.
+namespace oracleProtocol {
+    enum Op : uint32_t {
+        Error = 0,      // reply only: the request was refused
+        Setup = 1,      // payload SetupRequest, count 0; empty reply
+        Encrypt = 2,    // payload count blocks; reply count blocks
+        Decrypt = 3,
+        Stats = 4,      // count 0; reply payload StatsReply
+    };
+
+    enum Cipher : uint32_t {
+        WEMCipher = 1,       // WEM<p1, p2> under WEMKey(key), 16-byte blocks
+        SuperSboxCipher = 2, // superSbox::decrypt under mat and the box of key, 4-byte blocks
+    };
+
+    struct Header {
+        uint32_t op;
+        uint32_t count;
+    };
+
+    struct SetupRequest {
+        uint32_t cipher;
+        uint32_t p1, p2;
+        unsigned char key[16];
+        unsigned char mat[32][4];
+    };
+
+    // blocks answered on this connection, and messages received
+    struct StatsReply {
+        uint64_t messages;
+        uint64_t encrypted;
+        uint64_t decrypted;
+    };
+
+    constexpr uint32_t maxRounds = 10;
+    constexpr uint32_t maxCount = 1 << 20;
+
+    constexpr int blockSize(uint32_t cipher) { return cipher == SuperSboxCipher ? 4 : 16; }
+
+    inline SetupRequest wemSetup(const unsigned char key[16], uint32_t p1, uint32_t p2)
+    {
+        SetupRequest request = { WEMCipher, p1, p2, {}, {} };
+        memcpy(request.key, key, 16);
+        return request;
+    }
+
+    inline SetupRequest superSboxSetup(const unsigned char key[16], const unsigned char mat[32][4])
+    {
+        SetupRequest request = { SuperSboxCipher, 0, 0, {}, {} };
+        memcpy(request.key, key, 16);
+        memcpy(request.mat, mat, sizeof(request.mat));
+        return request;
+    }
+}
@@ -0,0 +1,168 @@
+#include "RemoteOracle.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace oracleProtocol;
+
+[[noreturn]] static void fail(const char *what)
+{
+    std::cerr << "oracle: " << what << (errno ? std::string(": ") + strerror(errno) : std::string()) << std::endl;
+    std::exit(1);
+}
+
+// MSG_NOSIGNAL: a server gone away is EPIPE here, not a SIGPIPE that ends the driver silently
+static void writeFull(int fd, const void *data, size_t len)
+{
+    auto p = static_cast<const char *>(data);
+    while (len > 0) {
+        const ssize_t n = send(fd, p, len, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) fail("write");
+        p += n;
+        len -= n;
+    }
+    return;
+}
+
+static void readFull(int fd, void *data, size_t len)
+{
+    auto p = static_cast<char *>(data);
+    while (len > 0) {
+        const ssize_t n = read(fd, p, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n == 0) errno = 0;
+        if (n <= 0) fail("read");
+        p += n;
+        len -= n;
+    }
+    return;
+}
+
+// a message holds at most maxCount blocks, and so does a full window
+RemoteOracle::RemoteOracle(const char *path, int batch, int window)
+    : batchBlocks(std::clamp<int>(batch, 1, maxCount)), windowMessages(std::clamp<int>(window, 1, maxCount / batchBlocks))
+{
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        errno = ENAMETOOLONG;
+        fail(path);
+    }
+    strcpy(addr.sun_path, path);
+
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) fail("socket");
+    if (connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0) fail(path);
+}
+
+RemoteOracle::~RemoteOracle()
+{
+    if (fd >= 0) close(fd);
+}
+
+// the count in variable name, fallback when it is unset; above limit it is
+// cut to limit with a note, anything but a positive number ends the process
+static int countFromEnvironment(const char *name, int fallback, int limit)
+{
+    const char *value = getenv(name);
+    if (!value || !*value) return fallback;
+
+    char *end;
+    errno = 0;
+    const long count = strtol(value, &end, 10);
+    if (*end || errno || count < 1) {
+        errno = 0;
+        fail((std::string(name) + "=" + value + " is not a positive count").c_str());
+    }
+    if (count > limit) {
+        std::cerr << "oracle: " << name << "=" << value << " cut to " << limit << std::endl;
+        return limit;
+    }
+    return static_cast<int>(count);
+}
+
+std::unique_ptr<RemoteOracle> RemoteOracle::fromEnvironment()
+{
+    const char *path = getenv("WEM_ORACLE");
+    if (!path || !*path) return nullptr;
+    const int batch = countFromEnvironment("WEM_ORACLE_BATCH", 256, maxCount);
+    const int window = countFromEnvironment("WEM_ORACLE_WINDOW", 4, maxCount / batch);
+    return std::unique_ptr<RemoteOracle>(new RemoteOracle(path, batch, window));
+}
+
+void RemoteOracle::setup(const SetupRequest& request)
+{
+    const Header header = { Setup, 0 };
+    writeFull(fd, &header, sizeof(header));
+    writeFull(fd, &request, sizeof(request));
+    ++sent;
+
+    Header reply;
+    readFull(fd, &reply, sizeof(reply));
+    errno = 0;
+    if (reply.op != Setup) fail("setup refused");
+    blockBytes = blockSize(request.cipher);
+    return;
+}
+
+// messages of up to batchBlocks blocks, at most windowMessages unanswered;
+// the server reads while it answers, so a full socket buffer cannot deadlock
+void RemoteOracle::call(uint32_t op, byte out[], const byte in[], int n)
+{
+    const int messages = (n + batchBlocks - 1) / batchBlocks;
+    int issued = 0;
+    for (int answered = 0; answered < messages; ++answered) {
+        for (; issued < messages && issued - answered < windowMessages; ++issued) {
+            const int first = issued * batchBlocks;
+            const Header header = { op, static_cast<uint32_t>(std::min(batchBlocks, n - first)) };
+            writeFull(fd, &header, sizeof(header));
+            writeFull(fd, in + static_cast<size_t>(first) * blockBytes, static_cast<size_t>(header.count) * blockBytes);
+        }
+
+        const int first = answered * batchBlocks;
+        const uint32_t expected = std::min(batchBlocks, n - first);
+        Header reply;
+        readFull(fd, &reply, sizeof(reply));
+        errno = 0;
+        if (reply.op != op || reply.count != expected) fail("request refused");
+        readFull(fd, out + static_cast<size_t>(first) * blockBytes, static_cast<size_t>(expected) * blockBytes);
+    }
+    count += n;
+    sent += messages;
+    return;
+}
+
+void RemoteOracle::encrypt(byte ciphertext[], const byte plaintext[], int n)
+{
+    call(Encrypt, ciphertext, plaintext, n);
+    return;
+}
+
+void RemoteOracle::decrypt(byte plaintext[], const byte ciphertext[], int n)
+{
+    call(Decrypt, plaintext, ciphertext, n);
+    return;
+}
+
+StatsReply RemoteOracle::serverStats()
+{
+    const Header header = { Stats, 0 };
+    writeFull(fd, &header, sizeof(header));
+    ++sent;
+
+    Header reply;
+    StatsReply stats;
+    readFull(fd, &reply, sizeof(reply));
+    errno = 0;
+    if (reply.op != Stats) fail("stats refused");
+    readFull(fd, &stats, sizeof(stats));
+    return stats;
+}
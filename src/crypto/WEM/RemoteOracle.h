@@ -0,0 +1,89 @@
+#pragma once
+
+#include "OracleProtocol.h"
+
+#include <memory>
+
+// Client of the oracle server (oracled) with the WEMOracle interface, so the
+// attack drivers can query a cipher in another process. A call of n blocks
+// goes out as messages of up to batch blocks, and up to window messages are
+// in flight before the first reply is read. Any socket or protocol error
+// ends the process: a driver cannot continue without its oracle.
+class RemoteOracle {
+    using byte = unsigned char;
+
+    private:
+        int fd = -1;
+        int blockBytes = 16;
+        int batchBlocks;
+        int windowMessages;
+        long long count = 0;
+        long long sent = 0;
+
+        void call(uint32_t op, byte out[], const byte in[], int n);
+
+    public:
+        RemoteOracle(const char *path, int batch, int window);
+        ~RemoteOracle();
+        RemoteOracle(const RemoteOracle&) = delete;
+        RemoteOracle& operator=(const RemoteOracle&) = delete;
+
+        // the cipher and key the server answers with from now on
+        void setup(const oracleProtocol::SetupRequest& request);
+
+        void encrypt(byte ciphertext[], const byte plaintext[], int n = 1);
+        void decrypt(byte plaintext[], const byte ciphertext[], int n = 1);
+
+        long long queries() const { return count; }
+        long long messages() const { return sent; }
+
+        // blocks worth gathering into one call: a full window of messages
+        int batch() const { return batchBlocks * windowMessages; }
+
+        // the server's own accounting of this connection
+        oracleProtocol::StatsReply serverStats();
+
+        // WEM_ORACLE names the socket, WEM_ORACLE_BATCH and WEM_ORACLE_WINDOW
+        // override the blocks per message (256) and messages in flight (4),
+        // cut so that a window holds at most oracleProtocol::maxCount blocks;
+        // null when WEM_ORACLE is unset
+        static std::unique_ptr<RemoteOracle> fromEnvironment();
+};
+
+// The oracle of a driver: the in-process Local one (a WEMOracle), or the
+// server when remote is not null. The branch is once per call, which costs
+// nothing next to the cipher.
+template <typename Local>
+class OracleSwitch {
+    using byte = unsigned char;
+
+    private:
+        Local local;
+        RemoteOracle *remote;
+
+    public:
+        OracleSwitch(Local local, RemoteOracle *remote) : local(local), remote(remote) {}
+
+        void encrypt(byte ciphertext[], const byte plaintext[], int n = 1)
+        {
+            if (remote) remote->encrypt(ciphertext, plaintext, n);
+            else local.encrypt(ciphertext, plaintext, n);
+            return;
+        }
+
+        void decrypt(byte plaintext[], const byte ciphertext[], int n = 1)
+        {
+            if (remote) remote->decrypt(plaintext, ciphertext, n);
+            else local.decrypt(plaintext, ciphertext, n);
+            return;
+        }
+
+        long long queries() const { return remote ? remote->queries() : local.queries(); }
+        int batch() const { return remote ? remote->batch() : local.batch(); }
+};
+
+template <typename Local>
+OracleSwitch<Local> selectOracle(Local local, RemoteOracle *remote)
+{
+    return OracleSwitch<Local>(local, remote);
+}
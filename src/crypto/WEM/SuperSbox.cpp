@@ -0,0 +1,68 @@
+#include "SuperSbox.h"
+#include "../GF/GF28.h"
+#include "../utils/component.h"
+#include "../utils/slayer.h"
+
+#include <cstring>
+
+// n states at once, so each byte substitution runs over all 4n bytes through
+// the S-layer kernel
+void superSbox::decrypt(unsigned char plaintext[][4], const unsigned char ciphertext[][4], int n,
+                        const unsigned char mat[32][4], const unsigned char invsbox[256])
+{
+    const unsigned char *invAESSbox = component::getAESInvSbox().data();
+    unsigned char *bytes = plaintext[0];
+
+    memcpy(bytes, ciphertext[0], 4 * n);
+
+    // inv affine A
+    for (int k = 0; k < n; ++k) {
+        unsigned int ciphernum = 0;
+        for (int row = 32 - 1; row >= 0; --row) {
+            unsigned char bit = mat[row][0] & plaintext[k][0];
+            bit ^= mat[row][1] & plaintext[k][1];
+            bit ^= mat[row][2] & plaintext[k][2];
+            bit ^= mat[row][3] & plaintext[k][3];
+
+            bit ^= (bit >> 4);
+            bit ^= (bit >> 2);
+            bit ^= (bit >> 1);
+
+            ciphernum = (ciphernum << 1) | (bit & 1);
+        }
+        plaintext[k][0] = (ciphernum >>  0) & 0xff;
+        plaintext[k][1] = (ciphernum >>  8) & 0xff;
+        plaintext[k][2] = (ciphernum >> 16) & 0xff;
+        plaintext[k][3] = (ciphernum >> 24) & 0xff;
+    }
+
+    // inv aes sbox
+    slayer::substituteBytes(bytes, 4 * n, invAESSbox);
+
+    for (int k = 0; k < n; ++k) {
+        // inv ark1
+        plaintext[k][0] ^= 0x62;
+        plaintext[k][1] ^= 0x63;
+        plaintext[k][2] ^= 0x63;
+        plaintext[k][3] ^= 0x63;
+
+        // inv mc
+        unsigned char state[4];
+        memcpy(state, plaintext[k], 4);
+
+        const unsigned char tmpState = state[0] ^ state[1] ^ state[2] ^ state[3];
+        plaintext[k][0] = state[0] ^ GF28::mul(0x09, tmpState) ^ GF28::mul(0x04, state[0] ^ state[2]) ^ GF28::mul(0x02, state[0] ^ state[1]);
+        plaintext[k][1] = state[1] ^ GF28::mul(0x09, tmpState) ^ GF28::mul(0x04, state[1] ^ state[3]) ^ GF28::mul(0x02, state[1] ^ state[2]);
+        plaintext[k][2] = state[2] ^ GF28::mul(0x09, tmpState) ^ GF28::mul(0x04, state[0] ^ state[2]) ^ GF28::mul(0x02, state[2] ^ state[3]);
+        plaintext[k][3] = state[3] ^ GF28::mul(0x09, tmpState) ^ GF28::mul(0x04, state[1] ^ state[3]) ^ GF28::mul(0x02, state[3] ^ state[0]);
+    }
+
+    // inv aes sbox
+    slayer::substituteBytes(bytes, 4 * n, invAESSbox);
+
+    // inv secret sbox
+    slayer::substituteBytes(bytes, 4 * n, invsbox);
+
+    return;
+}
+
@@ -0,0 +1,10 @@
+#pragma once
+
+// The 32-bit super S-box decryption oracle of supersbox: inverse secret
+// linear layer mat, AES S-box, the first-round key and InvMixColumns, AES
+// S-box and the secret S-box, on n 4-byte states. Shared by the supersbox
+// driver and the oracle server.
+namespace superSbox {
+    void decrypt(unsigned char plaintext[][4], const unsigned char ciphertext[][4], int n,
+                 const unsigned char mat[32][4], const unsigned char invsbox[256]);
+}
@@ -0,0 +1,299 @@
+#pragma once
+
+#include "../AES/AES128_ni.h"
+#include "../AES/AESCTR.h"
+#include "../AES/AESRound.h"
+#include "../utils/component.h"
+#include "../utils/slayer.h"
+
+#include <emmintrin.h>
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// The WEM family with the whole shape fixed at compile time:
+//   GenericWEM<Width, DistinctBoxes, P...>
+// has sizeof...(P) P-layers, P-layer l running P_l AES rounds under the
+// all-l key (PLayerKeys), between sizeof...(P) + 1 S-layers of Width-bit
+// S-boxes (8 or 16; a 16-bit S-layer reads the block as 8 little-endian
+// words). With DistinctBoxes S-layer l uses box l of the key, otherwise
+// every S-layer uses box 0. The layer loop is unrolled per instance, so the
+// rounds and box choice are constants in the generated code.
+//
+// WEM<P1, P2> (WEM_2EM.hpp) is GenericWEM<8, false, P1, P2> keyed by a
+// WEMKey, which holds the same boxes as GenericWEMKey for the same 16 bytes.
+
+/****************************    AES key schedule     ****************************************/
+inline void aes128_load_key(__m128i *roundkey, unsigned char masterkey[16])
+{
+    const auto& ops = AESRound::ops();
+    ops.expandKey(roundkey, masterkey);
+
+    for (int i = 11; i < 21; ++i)
+        roundkey[i] = ops.invMixColumns(roundkey[21 - i]);
+
+    return;
+}
+
+// The P-layer keys are fixed (P-layer l has all bytes l: 0x00 for PN1, 0x01
+// for PN2), so the schedules, with the equivalent inverse cipher keys in
+// 11..20, are expanded once on first use and shared by every WEM instance.
+class PLayerKeys {
+    public:
+        static constexpr int layers = 8;
+        __m128i rk[layers][21];
+
+        static const PLayerKeys& instance()
+        {
+            static const PLayerKeys keys;
+            return keys;
+        }
+
+    private:
+        PLayerKeys()
+        {
+            unsigned char pkey[16];
+            for (int type = 0; type < layers; ++type) {
+                memset(pkey, type, 16);
+                aes128_load_key(rk[type], pkey);
+            }
+        }
+};
+
+/****************************    family     ****************************************/
+
+// Boxes random Width-bit S-boxes and their inverses, consecutive draws from
+// one AES-CTR stream under key, so the first three 8-bit boxes are those of
+// WEMKey. The 16-bit boxes take 128 KiB each, hence the heap.
+template <int Width, int Boxes>
+class GenericWEMKey {
+    static_assert(Width == 8 || Width == 16, "S-boxes are 8 or 16 bits wide");
+
+    public:
+        using word = typename std::conditional<Width == 8, unsigned char, unsigned short>::type;
+        static constexpr int size = 1 << Width;
+
+        explicit GenericWEMKey(const unsigned char key[16]) : table(2 * Boxes * size)
+        {
+            AESCTR rng(key);
+            for (int l = 0; l < Boxes; ++l) {
+                if constexpr (Width == 8)
+                    component::generateBox(table.data() + l * size, table.data() + (Boxes + l) * size, rng);
+                else
+                    component::generateBox16(table.data() + l * size, table.data() + (Boxes + l) * size, rng);
+            }
+        }
+
+        const word* sbox(int l) const { return table.data() + l * size; }
+        const word* invsbox(int l) const { return table.data() + (Boxes + l) * size; }
+
+    private:
+        std::vector<word> table;
+};
+
+template <int Width, bool DistinctBoxes, int... P>
+class GenericWEM {
+    using byte = unsigned char;
+
+    public:
+        static constexpr int layers = sizeof...(P);
+        static constexpr int boxes = DistinctBoxes ? layers + 1 : 1;
+        using Key = GenericWEMKey<Width, boxes>;
+        using word = typename Key::word;
+
+    private:
+        static constexpr int rounds[layers] = { P... };
+
+        static_assert(layers >= 1, "at least one P-layer");
+        static_assert(layers <= PLayerKeys::layers, "too many P-layers for PLayerKeys");
+        static_assert(((P >= 0 && P <= 10) && ...), "the P-layer key schedule has 10 rounds");
+
+        static constexpr int box(int l) { return DistinctBoxes ? l : 0; }
+
+        void SLayerBatch(__m128i m[], int count, const word table[]);
+
+        template <int L>
+        void PLayerBatch(__m128i m[], int count);
+        template <int L>
+        void invPLayerBatch(__m128i m[], int count);
+
+        template <size_t... L>
+        void encryptLayers(__m128i m[], int count, const word *const tables[], std::index_sequence<L...>);
+        template <size_t... L>
+        void decryptLayers(__m128i m[], int count, const word *const tables[], std::index_sequence<L...>);
+
+    protected:
+        // the cipher with tables[l] for the S-layers on box l: the boxes to
+        // encrypt, their inverses to decrypt
+        void encryptBatch(byte ciphertext[], const byte plaintext[], int n, const word *const tables[]);
+        void decryptBatch(byte plaintext[], const byte ciphertext[], int n, const word *const tables[]);
+
+    public:
+        GenericWEM() = default;
+        ~GenericWEM() = default;
+        GenericWEM(const GenericWEM&) = delete;
+        GenericWEM& operator=(const GenericWEM&) = delete;
+
+        static GenericWEM& instance()
+        {
+            static GenericWEM GENERICINSTANCE;
+            return GENERICINSTANCE;
+        }
+
+        void WEMEncrypt(byte ciphertext[], const byte plaintext[], const Key& key)
+        {
+            WEMEncryptBatch(ciphertext, plaintext, 1, key);
+            return;
+        }
+
+        void WEMDecrypt(byte plaintext[], const byte ciphertext[], const Key& key)
+        {
+            WEMDecryptBatch(plaintext, ciphertext, 1, key);
+            return;
+        }
+
+        // n consecutive 16-byte blocks, the same result as n single calls.
+        // Up to AESRound::batchLanes blocks pass each layer together, so
+        // their AES rounds overlap (two blocks per instruction with VAES).
+        void WEMEncryptBatch(byte ciphertext[], const byte plaintext[], int n, const Key& key)
+        {
+            const word *tables[boxes];
+            for (int l = 0; l < boxes; ++l) tables[l] = key.sbox(l);
+            encryptBatch(ciphertext, plaintext, n, tables);
+            return;
+        }
+
+        void WEMDecryptBatch(byte plaintext[], const byte ciphertext[], int n, const Key& key)
+        {
+            const word *tables[boxes];
+            for (int l = 0; l < boxes; ++l) tables[l] = key.invsbox(l);
+            decryptBatch(plaintext, ciphertext, n, tables);
+            return;
+        }
+
+        template <int L>
+        void PLayer(byte text[]);
+
+        template <int L>
+        void invPLayer(byte text[]);
+};
+
+// WEM<P1, P2> and its three-layer variant with a fresh box per S-layer
+template <int P1 = 5, int P2 = 5>
+using WEM8 = GenericWEM<8, false, P1, P2>;
+template <int P1 = 5, int P2 = 5>
+using WEM8Distinct = GenericWEM<8, true, P1, P2>;
+// WEM<P1, P2> on eight 16-bit words, one box for all S-layers
+template <int P1 = 5, int P2 = 5>
+using WEM16 = GenericWEM<16, false, P1, P2>;
+
+/****************************    layers     ****************************************/
+template <int Width, bool DistinctBoxes, int... P>
+void GenericWEM<Width, DistinctBoxes, P...>::SLayerBatch(__m128i m[], int count, const word table[])
+{
+    if constexpr (Width == 8) {
+        slayer::substituteBytes(reinterpret_cast<byte*>(m), 16 * count, table);
+    } else {
+        // scalar: each word is a load from a 128 KiB table, bound by cache misses that gathers do not hide
+        unsigned short w[8];
+        for (int j = 0; j < count; ++j) {
+            memcpy(w, &m[j], 16);
+            for (int i = 0; i < 8; ++i) w[i] = table[w[i]];
+            memcpy(&m[j], w, 16);
+        }
+    }
+    return;
+}
+
+template <int Width, bool DistinctBoxes, int... P>
+template <int L>
+void GenericWEM<Width, DistinctBoxes, P...>::PLayerBatch(__m128i m[], int count)
+{
+    const __m128i *k = PLayerKeys::instance().rk[L];
+
+    for (int j = 0; j < count; ++j) m[j] = _mm_xor_si128(m[j], k[0]);
+    AESRound::ops().encRoundsBatch(m, count, k + 1, rounds[L]);
+    return;
+}
+
+template <int Width, bool DistinctBoxes, int... P>
+template <int L>
+void GenericWEM<Width, DistinctBoxes, P...>::invPLayerBatch(__m128i m[], int count)
+{
+    constexpr int r = rounds[L];
+    const __m128i *k = PLayerKeys::instance().rk[L];
+
+    const auto& ops = AESRound::ops();
+    for (int j = 0; j < count; ++j) m[j] = _mm_xor_si128(ops.encLast(m[j], m[j]), m[j]);
+    ops.decRoundsBatch(m, count, k + 21 - r, r);
+    for (int j = 0; j < count; ++j) m[j] = ops.decLast(m[j], k[0]);
+    return;
+}
+
+template <int Width, bool DistinctBoxes, int... P>
+template <int L>
+void GenericWEM<Width, DistinctBoxes, P...>::PLayer(byte text[16])
+{
+    auto m = _mm_loadu_si128((__m128i *)text);
+    PLayerBatch<L>(&m, 1);
+    _mm_storeu_si128((__m128i *)text, m);
+    return;
+}
+
+template <int Width, bool DistinctBoxes, int... P>
+template <int L>
+void GenericWEM<Width, DistinctBoxes, P...>::invPLayer(byte text[16])
+{
+    auto m = _mm_loadu_si128((__m128i *)text);
+    invPLayerBatch<L>(&m, 1);
+    _mm_storeu_si128((__m128i *)text, m);
+    return;
+}
+
+/****************************    cipher     ****************************************/
+// S_0 P_0 S_1 ... P_{n-1} S_n, and back; the folds run left to right
+template <int Width, bool DistinctBoxes, int... P>
+template <size_t... L>
+void GenericWEM<Width, DistinctBoxes, P...>::encryptLayers(__m128i m[], int count, const word *const tables[], std::index_sequence<L...>)
+{
+    ((SLayerBatch(m, count, tables[box(L)]), PLayerBatch<L>(m, count)), ...);
+    SLayerBatch(m, count, tables[box(layers)]);
+    return;
+}
+
+template <int Width, bool DistinctBoxes, int... P>
+template <size_t... L>
+void GenericWEM<Width, DistinctBoxes, P...>::decryptLayers(__m128i m[], int count, const word *const tables[], std::index_sequence<L...>)
+{
+    SLayerBatch(m, count, tables[box(layers)]);
+    ((invPLayerBatch<layers - 1 - L>(m, count), SLayerBatch(m, count, tables[box(layers - 1 - L)])), ...);
+    return;
+}
+
+template <int Width, bool DistinctBoxes, int... P>
+void GenericWEM<Width, DistinctBoxes, P...>::encryptBatch(byte ciphertext[], const byte plaintext[], int n, const word *const tables[])
+{
+    __m128i m[AESRound::batchLanes];
+    for (int b = 0; b < n; b += AESRound::batchLanes) {
+        const int count = std::min(AESRound::batchLanes, n - b);
+        memcpy(m, plaintext + 16 * b, 16 * count);
+        encryptLayers(m, count, tables, std::make_index_sequence<layers>());
+        memcpy(ciphertext + 16 * b, m, 16 * count);
+    }
+    return;
+}
+
+template <int Width, bool DistinctBoxes, int... P>
+void GenericWEM<Width, DistinctBoxes, P...>::decryptBatch(byte plaintext[], const byte ciphertext[], int n, const word *const tables[])
+{
+    __m128i m[AESRound::batchLanes];
+    for (int b = 0; b < n; b += AESRound::batchLanes) {
+        const int count = std::min(AESRound::batchLanes, n - b);
+        memcpy(m, ciphertext + 16 * b, 16 * count);
+        decryptLayers(m, count, tables, std::make_index_sequence<layers>());
+        memcpy(plaintext + 16 * b, m, 16 * count);
+    }
+    return;
+}
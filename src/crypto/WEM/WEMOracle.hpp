@@ -0,0 +1,52 @@
+#pragma once
+
+#include "WEM_2EM.hpp"
+
+// Chosen plaintext / ciphertext oracle over one secret key, for the attack
+// drivers. It holds references to the cipher (WEM<P1, P2>, BitslicedWEM<P1,
+// P2> or a GenericWEM with its Key) and the key, so a query copies neither and inlines
+// into the query loop, and it counts the blocks queried.
+//
+// Code that queries an oracle takes it as a template parameter and needs
+//   void encrypt(byte out[], const byte in[], int n = 1);
+//   void decrypt(byte out[], const byte in[], int n = 1);
+//   long long queries() const;
+//   int batch() const;
+// with n consecutive 16-byte blocks per call. batch() is how many blocks a
+// driver should gather into one call; in process that is 1, so a driver that
+// stops at the rank it needs queries no block it does not use.
+template <typename Cipher, typename Key = WEMKey>
+class WEMOracle {
+    using byte = unsigned char;
+
+    private:
+        Cipher& cipher;
+        const Key& key;
+        long long count = 0;
+
+    public:
+        WEMOracle(Cipher& cipher, const Key& key) : cipher(cipher), key(key) {}
+
+        void encrypt(byte ciphertext[], const byte plaintext[], int n = 1)
+        {
+            cipher.WEMEncryptBatch(ciphertext, plaintext, n, key);
+            count += n;
+            return;
+        }
+
+        void decrypt(byte plaintext[], const byte ciphertext[], int n = 1)
+        {
+            cipher.WEMDecryptBatch(plaintext, ciphertext, n, key);
+            count += n;
+            return;
+        }
+
+        long long queries() const { return count; }
+        int batch() const { return 1; }
+};
+
+template <typename Cipher, typename Key>
+WEMOracle<Cipher, Key> makeOracle(Cipher& cipher, const Key& key)
+{
+    return WEMOracle<Cipher, Key>(cipher, key);
+}
@@ -0,0 +1,26 @@
+#include "Batch.h"
+#include "Elimination.h"
+
+std::vector<int> linalg::rrefBatch(GF28Matrix *const *systems, int count, const SolverOptions& options)
+{
+    const int threads = teamSize(options.threads);
+
+    // one system per worker; parallelism comes from the batch, not the sweep
+    SolverOptions single = options;
+    single.threads = 1;
+
+    std::vector<int> ranks(count, 0);
+    // dynamic: solve times differ with rank and sparsity, idle workers take the next system
+    #pragma omp parallel for schedule(dynamic, 1) num_threads(threads) if (threads > 1)
+    for (int i = 0; i < count; ++i)
+        ranks[i] = systems[i]->rref(single);
+    return ranks;
+}
+
+std::vector<int> linalg::rrefBatch(std::vector<GF28Matrix>& systems, const SolverOptions& options)
+{
+    std::vector<GF28Matrix*> ptrs;
+    ptrs.reserve(systems.size());
+    for (auto& system : systems) ptrs.push_back(&system);
+    return rrefBatch(ptrs.data(), static_cast<int>(ptrs.size()), options);
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "GF28Matrix.h"
+
+#include <vector>
+
+namespace linalg {
+    // Throughput mode for many independent systems: each system is brought to
+    // reduced row echelon form in place by one thread, and the systems are
+    // handed out to options.threads workers as they become free. The engine
+    // is options.strategy. Returns the ranks, in the order of systems.
+    std::vector<int> rrefBatch(std::vector<GF28Matrix>& systems, const SolverOptions& options = {});
+
+    // same, for systems that are not stored together
+    std::vector<int> rrefBatch(GF28Matrix *const *systems, int count, const SolverOptions& options = {});
+}
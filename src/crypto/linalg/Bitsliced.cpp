@@ -0,0 +1,188 @@
+#include "Elimination.h"
+#include "../GF/GF28.h"
+#include "../GF/GF28Region.h"
+
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <emmintrin.h>
+#include <utility>
+#include <vector>
+
+// Bitsliced layout: every 64 columns of a row become 8 words, word p holding
+// bit p of those 64 entries. A row keeps its byte length (rowStride()) and
+// each 64-column group is one cache line.
+
+// dst = bit planes of the bytes src[0, 64 * groups)
+static void toPlanes(uint64_t *dst, const unsigned char *src, int groups)
+{
+    for (int g = 0; g < groups; ++g) {
+        uint64_t *w = dst + 8 * g;
+        for (int p = 0; p < 8; ++p) w[p] = 0;
+        for (int i = 0; i < 4; ++i) {
+            const auto x = _mm_load_si128((const __m128i *)(src + 64 * g + 16 * i));
+            // shifting each lane left by 7 - p brings bit p of every byte to its top bit
+            for (int p = 0; p < 8; ++p) {
+                const auto bits = _mm_movemask_epi8(_mm_slli_epi64(x, 7 - p));
+                w[p] |= static_cast<uint64_t>(bits) << (16 * i);
+            }
+        }
+    }
+    return;
+}
+
+// spread[x] has byte i = bit i of x
+constexpr auto _ct_genSpread()
+{
+    std::array<uint64_t, 256> spread = { 0 };
+    for (int x = 0; x < 256; ++x)
+        for (int i = 0; i < 8; ++i)
+            spread[x] |= static_cast<uint64_t>((x >> i) & 1) << (8 * i);
+    return spread;
+}
+constexpr auto spread = _ct_genSpread();
+
+static void fromPlanes(unsigned char *dst, const uint64_t *src, int groups)
+{
+    for (int g = 0; g < groups; ++g) {
+        const uint64_t *w = src + 8 * g;
+        for (int k = 0; k < 8; ++k) {
+            uint64_t x = 0;
+            for (int p = 0; p < 8; ++p) x |= spread[(w[p] >> (8 * k)) & 0xff] << p;
+            memcpy(dst + 64 * g + 8 * k, &x, 8);
+        }
+    }
+    return;
+}
+
+static inline unsigned char coefficient(const uint64_t *row, int col)
+{
+    const uint64_t *w = row + col / 64 * 8;
+    unsigned char c = 0x00;
+    for (int p = 0; p < 8; ++p) c |= ((w[p] >> (col % 64)) & 1) << p;
+    return c;
+}
+
+static inline bool isNonZero(const uint64_t *row, int col)
+{
+    const uint64_t *w = row + col / 64 * 8;
+    const uint64_t any = w[0] | w[1] | w[2] | w[3] | w[4] | w[5] | w[6] | w[7];
+    return (any >> (col % 64)) & 1;
+}
+
+// dst = 0x02 * src on groups [from, groups); multiplying by x is a fixed
+// combination of planes since x^8 = x^4 + x^3 + x + 1
+static void mulX(uint64_t *dst, const uint64_t *src, int from, int groups)
+{
+    for (int g = from; g < groups; ++g) {
+        const uint64_t *s = src + 8 * g;
+        uint64_t *d = dst + 8 * g;
+        d[0] = s[7];
+        d[1] = s[0] ^ s[7];
+        d[2] = s[1];
+        d[3] = s[2] ^ s[7];
+        d[4] = s[3] ^ s[7];
+        d[5] = s[4];
+        d[6] = s[5];
+        d[7] = s[6];
+    }
+    return;
+}
+
+// lo[x] = x * eq and hi[x] = (x << 4) * eq for x < 16, filled in Gray code
+// order with one row xor per entry; all rows are `stride` bytes apart
+static void genPlaneTables(unsigned char *lo, unsigned char *hi, unsigned char *basis, const unsigned char *eq, int from, int len, int stride)
+{
+    const int groups = len / 64;
+    memcpy(basis + from, eq + from, len - from);
+    for (int p = 1; p < 8; ++p)
+        mulX(reinterpret_cast<uint64_t*>(basis + p * stride), reinterpret_cast<const uint64_t*>(basis + (p - 1) * stride), from / 64, groups);
+
+    memset(lo + from, 0x00, len - from);
+    memset(hi + from, 0x00, len - from);
+    for (int i = 1; i < 16; ++i) {
+        const int cur = i ^ (i >> 1), prev = (i - 1) ^ ((i - 1) >> 1);
+        const int bit = __builtin_ctz(i);  // the bit flipped between prev and cur
+        memcpy(lo + cur * stride + from, lo + prev * stride + from, len - from);
+        GF28::xorRegion(lo + cur * stride + from, basis + bit * stride + from, len - from);
+        memcpy(hi + cur * stride + from, hi + prev * stride + from, len - from);
+        GF28::xorRegion(hi + cur * stride + from, basis + (bit + 4) * stride + from, len - from);
+    }
+    return;
+}
+
+// Gauss-Jordan on the bitsliced copy. Each pivot gets two 16-entry nibble
+// tables of its multiples, so a row update is two table rows xored in and
+// never a byte shuffle; the pivot row is normalised from the same tables.
+// Rows from the pivot row down are zero left of the pivot column, so the
+// updates start at its 64-column group.
+int linalg::eliminateBitsliced(GF28Matrix& m, std::vector<int>& pivots, const SolverOptions& options)
+{
+    const int rows = m.rows();
+    const int len = m.rowStride();
+    const int groups = len / 64;
+    // padded by a cache line, see eliminateFourRussians
+    const int stride = len + GF28Matrix::alignment;
+    const int threads = teamSize(options.threads);
+
+    auto planes = static_cast<unsigned char*>(std::aligned_alloc(GF28Matrix::alignment, static_cast<size_t>(rows) * len));
+    auto tables = static_cast<unsigned char*>(std::aligned_alloc(GF28Matrix::alignment, 32 * stride));
+    auto basis = static_cast<unsigned char*>(std::aligned_alloc(GF28Matrix::alignment, 8 * stride));
+    std::vector<unsigned char*> row(rows);
+    for (int r = 0; r < rows; ++r) row[r] = planes + static_cast<size_t>(r) * len;
+    const auto words = [&](int r) { return reinterpret_cast<uint64_t*>(row[r]); };
+
+    #pragma omp parallel num_threads(threads) if (threads > 1)
+    {
+        #pragma omp for schedule(static)
+        for (int r = 0; r < rows; ++r)
+            toPlanes(words(r), m[r], groups);
+
+        for (int col = 0, firstRow = 0; col < m.cols() && firstRow < rows; ++col) {
+            const int from = col / 64 * 64;
+            int pivotRow = -1;
+            unsigned char invPivot = 0x00;
+            #pragma omp single copyprivate(pivotRow, invPivot)
+            {
+                for (int r = firstRow; r < rows && pivotRow < 0; ++r)
+                    if (isNonZero(words(r), col)) pivotRow = r;
+                if (pivotRow >= 0) {
+                    std::swap(row[firstRow], row[pivotRow]);
+                    pivots.push_back(col);
+                    auto pivotEq = row[firstRow];
+                    invPivot = GF28::inv(coefficient(words(firstRow), col));
+                    genPlaneTables(tables, tables + 16 * stride, basis, pivotEq, from, len, stride);
+                    memcpy(pivotEq + from, tables + (invPivot & 0x0f) * stride + from, len - from);
+                    GF28::xorRegion(pivotEq + from, tables + (16 + (invPivot >> 4)) * stride + from, len - from);
+                }
+            }
+            if (pivotRow < 0) continue;
+
+            // the tables hold multiples of the pivot row before normalisation
+            #pragma omp for schedule(static)
+            for (int r = 0; r < rows; ++r) {
+                if (r == firstRow) continue;
+                const unsigned char c = coefficient(words(r), col);
+                if (c == 0x00) continue;
+                const unsigned char f = GF28::mul(c, invPivot);
+                const unsigned char *srcs[2];
+                int count = 0;
+                if (f & 0x0f) srcs[count++] = tables + (f & 0x0f) * stride + from;
+                if (f >> 4) srcs[count++] = tables + (16 + (f >> 4)) * stride + from;
+                GF28::xorRegions(row[r] + from, srcs, count, len - from);
+            }
+
+            ++firstRow;
+        }
+
+        #pragma omp for schedule(static)
+        for (int r = 0; r < rows; ++r)
+            fromPlanes(m[r], words(r), groups);
+    }
+
+    std::free(basis);
+    std::free(tables);
+    std::free(planes);
+    return static_cast<int>(pivots.size());
+}
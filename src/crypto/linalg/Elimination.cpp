@@ -0,0 +1,400 @@
+#include "Elimination.h"
+#include "../GF/GF28.h"
+#include "../GF/GF28Region.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <emmintrin.h>
+
+namespace {
+    // Occupancy bitmaps of the active 64-column block, a transposed shadow of
+    // the matrix: bit j of word[row] is set when m[row][64 block + j] != 0.
+    // The words are contiguous over the rows, so a column test reads 8 bytes
+    // per row instead of a byte from a different cache line, and the pivot
+    // search tests four rows per step. A row refreshes its word after each
+    // update; the next block is rebuilt once the pivot column reaches it.
+    class Occupancy {
+        private:
+            int block = -1;
+            std::vector<uint64_t> words;
+
+            static uint64_t nonzero(const unsigned char *eq)
+            {
+                const auto zero = _mm_setzero_si128();
+                uint64_t zeros = 0;
+                for (int i = 0; i < 4; ++i) {
+                    const auto x = _mm_load_si128((const __m128i *)(eq + 16 * i));
+                    zeros |= static_cast<uint64_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(x, zero))) << (16 * i);
+                }
+                return ~zeros;
+            }
+
+        public:
+            explicit Occupancy(int rows) : words(rows) {}
+
+            // make the block of col the active one
+            void select(const GF28Matrix& m, int col)
+            {
+                if (col / 64 == block) return;
+                block = col / 64;
+                for (int row = 0; row < m.rows(); ++row) words[row] = nonzero(m[row] + 64 * block);
+                return;
+            }
+
+            void refresh(const unsigned char *eq, int row)
+            {
+                words[row] = nonzero(eq + 64 * block);
+                return;
+            }
+
+            bool test(int row, int col) const { return (words[row] >> (col % 64)) & 1; }
+
+            void swap(int row1, int row2)
+            {
+                std::swap(words[row1], words[row2]);
+                return;
+            }
+
+            // first row in [firstRow, rows) with a non-zero entry in col, or -1
+            int find(int col, int firstRow) const
+            {
+                const int rows = static_cast<int>(words.size());
+                const auto mask = _mm_set1_epi64x(static_cast<long long>(1ull << (col % 64)));
+                const auto zero = _mm_setzero_si128();
+                int row = firstRow;
+                for (; row + 4 <= rows; row += 4) {
+                    const auto a = _mm_and_si128(_mm_loadu_si128((const __m128i *)(words.data() + row)), mask);
+                    const auto b = _mm_and_si128(_mm_loadu_si128((const __m128i *)(words.data() + row + 2)), mask);
+                    if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_or_si128(a, b), zero)) != 0xffff) break;
+                }
+                for (; row < rows; ++row)
+                    if (test(row, col)) return row;
+                return -1;
+            }
+    };
+}
+
+// with deferred normalisation: scale every pivot row so its pivot becomes 1,
+// shared across the team of the enclosing parallel region
+static void normalizePivots(GF28Matrix& m, const std::vector<int>& pivots)
+{
+    #pragma omp for schedule(static)
+    for (int row = 0; row < static_cast<int>(pivots.size()); ++row)
+        GF28::mulRegion(m[row], m[row], GF28::inv(m[row][pivots[row]]), m.rowStride());
+    return;
+}
+
+// Every engine keeps the same shape: pivot search and pivot-row set-up run
+// on one thread, then the row sweep is split statically across the team.
+// Each row update only reads the pivot row, so the result does not depend on
+// the thread count. The per-pivot engines find pivots and the rows to update
+// through the occupancy bitmaps; a row refreshes its own word after its
+// update, so threads never write the same word.
+int linalg::eliminateNaive(GF28Matrix& m, std::vector<int>& pivots, const SolverOptions& options)
+{
+    const int len = m.rowStride();
+    const int threads = teamSize(options.threads);
+    Occupancy occupancy(m.rows());
+
+    #pragma omp parallel num_threads(threads) if (threads > 1)
+    {
+        for (int col = 0, firstRow = 0; col < m.cols() && firstRow < m.rows(); ++col) {
+            int pivotRow;
+            unsigned char scale = 0x01;     // 1 / pivot while the pivot row is unscaled
+            #pragma omp single copyprivate(pivotRow, scale)
+            {
+                occupancy.select(m, col);
+                pivotRow = occupancy.find(col, firstRow);
+                if (pivotRow >= 0) {
+                    m.swapRows(firstRow, pivotRow);
+                    occupancy.swap(firstRow, pivotRow);
+                    pivots.push_back(col);
+                    auto pivotEq = m[firstRow];
+                    scale = GF28::inv(pivotEq[col]);
+                    if (!options.deferNormalization) {
+                        GF28::mulRegion(pivotEq, pivotEq, scale, len);
+                        scale = 0x01;
+                    }
+                }
+            }
+            if (pivotRow < 0) continue;
+
+            const auto pivotEq = m[firstRow];
+            #pragma omp for schedule(static)
+            for (int row = 0; row < m.rows(); ++row)
+                if (occupancy.test(row, col) && row != firstRow) {
+                    GF28::mulAddRegion(m[row], pivotEq, GF28::mul(m[row][col], scale), len);
+                    occupancy.refresh(m[row], row);
+                }
+
+            ++firstRow;
+        }
+        if (options.deferNormalization) normalizePivots(m, pivots);
+    }
+
+    return static_cast<int>(pivots.size());
+}
+
+// number of zeros
+static inline unsigned char ntz(unsigned char x)
+{
+    if (x == 0) return 0;
+    unsigned char n = 0;
+    if ((x >> 4) != 0) { n += 4; x >>= 4; }
+    if ((x >> 2) != 0) { n += 2; x >>= 2; }
+    n = n + (x >> 1);
+    return n;
+}
+static inline int g(int n)
+{
+    return n ^ (n >> 1);
+}
+static inline int g_inv(int g)
+{
+    int n = 0;
+    while (g) {
+        n ^= g;
+        g >>= 1;
+    }
+    return n;
+}
+
+// mulTable[g_inv(c)] = c * eq, filled in Gray code order with one row xor per entry
+static void genMulTableRow(unsigned char *mulTable, unsigned char *bitRow, const unsigned char *eq, int len)
+{
+    memcpy(bitRow, eq, len);
+    for (int i = 1; i < 8; ++i)
+        GF28::mulRegion(bitRow + i * len, bitRow + (i - 1) * len, 0x02, len);
+
+    memset(mulTable, 0x00, len);
+    for (int i = 1; i < 256; ++i) {
+        const unsigned char addBit = g(i - 1) ^ g(i);
+        const unsigned char rowi = ntz(addBit);
+        memcpy(mulTable + i * len, mulTable + (i - 1) * len, len);
+        GF28::xorRegion(mulTable + i * len, bitRow + rowi * len, len);
+    }
+    return;
+}
+
+int linalg::eliminateGrayCode(GF28Matrix& m, std::vector<int>& pivots, const SolverOptions& options)
+{
+    const int len = m.rowStride();
+    const int threads = teamSize(options.threads);
+    auto mulTable = static_cast<unsigned char*>(std::aligned_alloc(GF28Matrix::alignment, 256 * len));
+    auto bitRow = static_cast<unsigned char*>(std::aligned_alloc(GF28Matrix::alignment, 8 * len));
+    Occupancy occupancy(m.rows());
+
+    #pragma omp parallel num_threads(threads) if (threads > 1)
+    {
+        for (int col = 0, firstRow = 0; col < m.cols() && firstRow < m.rows(); ++col) {
+            int pivotRow;
+            unsigned char scale = 0x01;     // 1 / pivot while the pivot row is unscaled
+            #pragma omp single copyprivate(pivotRow, scale)
+            {
+                occupancy.select(m, col);
+                pivotRow = occupancy.find(col, firstRow);
+                if (pivotRow >= 0) {
+                    m.swapRows(firstRow, pivotRow);
+                    occupancy.swap(firstRow, pivotRow);
+                    pivots.push_back(col);
+                    auto pivotEq = m[firstRow];
+                    scale = GF28::inv(pivotEq[col]);
+                    if (!options.deferNormalization) {
+                        GF28::mulRegion(pivotEq, pivotEq, scale, len);
+                        scale = 0x01;
+                    }
+                    genMulTableRow(mulTable, bitRow, pivotEq, len);
+                }
+            }
+            if (pivotRow < 0) continue;
+
+            #pragma omp for schedule(static)
+            for (int row = 0; row < m.rows(); ++row)
+                if (occupancy.test(row, col) && row != firstRow) {
+                    GF28::xorRegion(m[row], mulTable + g_inv(GF28::mul(m[row][col], scale)) * len, len);
+                    occupancy.refresh(m[row], row);
+                }
+
+            ++firstRow;
+        }
+        if (options.deferNormalization) normalizePivots(m, pivots);
+    }
+
+    std::free(bitRow);
+    std::free(mulTable);
+    return static_cast<int>(pivots.size());
+}
+
+/****************************    blocked     ****************************************/
+// pivots per panel; the panel rows stay in L1 during the trailing update
+constexpr int panelSize = 16;
+// bytes of a row updated by all panel pivots before moving on
+constexpr int chunkSize = 2048;
+
+// row -= sum_j row[pivots[j]] * panel[j]; the panel rows are mutually reduced
+// (panel[j][pivots[i]] = [i == j]), so all coefficients can be read up front
+static void reduceByPanel(unsigned char *row, unsigned char *const *panel, const int *pivots, int k, int from, int len)
+{
+    unsigned char coef[panelSize];
+    bool any = false;
+    for (int j = 0; j < k; ++j) {
+        coef[j] = row[pivots[j]];
+        any |= coef[j] != 0x00;
+    }
+    if (!any) return;
+
+    for (int chunk = from; chunk < len; chunk += chunkSize) {
+        const int n = std::min(chunkSize, len - chunk);
+        for (int j = 0; j < k; ++j)
+            GF28::mulAddRegion(row + chunk, panel[j] + chunk, coef[j], n);
+    }
+    return;
+}
+
+// Finds up to maxPivots pivots from column col on, moves them to rows
+// [firstRow, firstRow + k) and reduces them against each other. Rows scanned
+// on the way are reduced by the pivots found so far. col is advanced past the
+// last column examined; returns k.
+static int factorPanel(GF28Matrix& m, std::vector<int>& pivots, int firstRow, int& col, int maxPivots)
+{
+    const int len = m.rowStride();
+    // rows below firstRow are zero left of col, so are all panel rows
+    const int from = col / GF28Matrix::alignment * GF28Matrix::alignment;
+    unsigned char *panel[panelSize];
+
+    int k = 0;
+    for (; col < m.cols() && k < maxPivots && firstRow + k < m.rows(); ++col) {
+        const int *panelPivots = pivots.data() + firstRow;
+        int pivotRow = -1;
+        for (int row = firstRow + k; row < m.rows(); ++row) {
+            reduceByPanel(m[row], panel, panelPivots, k, from, len);
+            if (m[row][col]) {
+                pivotRow = row;
+                break;
+            }
+        }
+        if (pivotRow < 0) continue;
+
+        m.swapRows(firstRow + k, pivotRow);
+        pivots.push_back(col);
+        auto pivotEq = m[firstRow + k];
+        GF28::mulRegion(pivotEq + from, pivotEq + from, GF28::inv(pivotEq[col]), len - from);
+        for (int j = 0; j < k; ++j)
+            GF28::mulAddRegion(panel[j] + from, pivotEq + from, panel[j][col], len - from);
+        panel[k++] = pivotEq;
+    }
+    return k;
+}
+
+// k-pivot block Gauss-Jordan. A panel of up to panelSize pivots is found and
+// reduced against itself on one thread, then every other row is reduced by
+// the whole panel in a single pass, column chunk by column chunk. A row is
+// read once per panel instead of once per pivot.
+int linalg::eliminateBlocked(GF28Matrix& m, std::vector<int>& pivots, const SolverOptions& options)
+{
+    const int len = m.rowStride();
+    const int threads = teamSize(options.threads);
+
+    #pragma omp parallel num_threads(threads) if (threads > 1)
+    for (int col = 0, firstRow = 0; col < m.cols() && firstRow < m.rows(); ) {
+        int k = 0;
+        int nextCol = col;
+        #pragma omp single copyprivate(k, nextCol)
+        k = factorPanel(m, pivots, firstRow, nextCol, panelSize);
+        if (k == 0) break;
+
+        unsigned char *panel[panelSize];
+        for (int j = 0; j < k; ++j) panel[j] = m[firstRow + j];
+        const int *panelPivots = pivots.data() + firstRow;
+        const int from = col / GF28Matrix::alignment * GF28Matrix::alignment;
+
+        #pragma omp for schedule(static)
+        for (int row = 0; row < m.rows(); ++row)
+            if (row < firstRow || row >= firstRow + k)
+                reduceByPanel(m[row], panel, panelPivots, k, from, len);
+
+        col = nextCol;
+        firstRow += k;
+    }
+
+    return static_cast<int>(pivots.size());
+}
+
+/****************************    Four Russians     ****************************************/
+// pivots per panel; each row update then xors 2 * 8 table rows in one pass
+constexpr int russiansPanel = 8;
+
+// lo[x] = x * eq and hi[x] = (x << 4) * eq for x < 16, each filled in Gray
+// code order with one row xor per entry
+static void genNibbleTables(unsigned char *lo, unsigned char *hi, unsigned char *bitRow, const unsigned char *eq, int from, int len, int stride)
+{
+    memcpy(bitRow + from, eq + from, len - from);
+    for (int i = 1; i < 8; ++i)
+        GF28::mulRegion(bitRow + i * stride + from, bitRow + (i - 1) * stride + from, 0x02, len - from);
+
+    memset(lo + from, 0x00, len - from);
+    memset(hi + from, 0x00, len - from);
+    for (int i = 1; i < 16; ++i) {
+        const unsigned char rowi = ntz(g(i - 1) ^ g(i));
+        memcpy(lo + g(i) * stride + from, lo + g(i - 1) * stride + from, len - from);
+        GF28::xorRegion(lo + g(i) * stride + from, bitRow + rowi * stride + from, len - from);
+        memcpy(hi + g(i) * stride + from, hi + g(i - 1) * stride + from, len - from);
+        GF28::xorRegion(hi + g(i) * stride + from, bitRow + (rowi + 4) * stride + from, len - from);
+    }
+    return;
+}
+
+// Method of Four Russians on top of the blocked panels. Each panel pivot gets
+// two 16-entry nibble tables (32 rows, 8 KB for a 256-column system instead
+// of the 64 KB of the 256-multiple table), so c * pivot is two table rows and
+// the trailing update is xors only.
+int linalg::eliminateFourRussians(GF28Matrix& m, std::vector<int>& pivots, const SolverOptions& options)
+{
+    const int len = m.rowStride();
+    // padded by a cache line, otherwise the table rows read by one update
+    // alias to the same L1 sets whenever len is a multiple of 4 KB
+    const int stride = len + GF28Matrix::alignment;
+    const int threads = teamSize(options.threads);
+    const size_t tableRows = 32 * russiansPanel;
+    auto tables = static_cast<unsigned char*>(std::aligned_alloc(GF28Matrix::alignment, tableRows * stride));
+    auto bitRow = static_cast<unsigned char*>(std::aligned_alloc(GF28Matrix::alignment, 8 * stride));
+
+    #pragma omp parallel num_threads(threads) if (threads > 1)
+    for (int col = 0, firstRow = 0; col < m.cols() && firstRow < m.rows(); ) {
+        const int from = col / GF28Matrix::alignment * GF28Matrix::alignment;
+        int k = 0;
+        int nextCol = col;
+        #pragma omp single copyprivate(k, nextCol)
+        {
+            k = factorPanel(m, pivots, firstRow, nextCol, russiansPanel);
+            for (int j = 0; j < k; ++j)
+                genNibbleTables(tables + 32 * j * stride, tables + (32 * j + 16) * stride, bitRow, m[firstRow + j], from, len, stride);
+        }
+        if (k == 0) break;
+
+        const int *panelPivots = pivots.data() + firstRow;
+        #pragma omp for schedule(static)
+        for (int row = 0; row < m.rows(); ++row) {
+            if (row >= firstRow && row < firstRow + k) continue;
+
+            const unsigned char *srcs[2 * russiansPanel];
+            int count = 0;
+            for (int j = 0; j < k; ++j) {
+                const unsigned char c = m[row][panelPivots[j]];
+                if (c == 0x00) continue;
+                srcs[count++] = tables + (32 * j + (c & 0x0f)) * stride + from;
+                srcs[count++] = tables + (32 * j + 16 + (c >> 4)) * stride + from;
+            }
+            if (count) GF28::xorRegions(m[row] + from, srcs, count, len - from);
+        }
+
+        col = nextCol;
+        firstRow += k;
+    }
+
+    std::free(bitRow);
+    std::free(tables);
+    return static_cast<int>(pivots.size());
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "GF28Matrix.h"
+
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Elimination engines behind GF28Matrix::rref(). Each brings the matrix to
+// reduced row echelon form in place, appends the pivot columns in row order
+// and returns the rank.
+namespace linalg {
+    // OpenMP team for SolverOptions::threads; threads <= 0 asks for one thread per core
+    inline int teamSize(int threads)
+    {
+#ifdef _OPENMP
+        if (threads <= 0) return omp_get_max_threads();
+#endif
+        return threads > 0 ? threads : 1;
+    }
+
+    int eliminateNaive(GF28Matrix& m, std::vector<int>& pivots, const SolverOptions& options);
+    int eliminateGrayCode(GF28Matrix& m, std::vector<int>& pivots, const SolverOptions& options);
+    int eliminateBlocked(GF28Matrix& m, std::vector<int>& pivots, const SolverOptions& options);
+    int eliminateFourRussians(GF28Matrix& m, std::vector<int>& pivots, const SolverOptions& options);
+    int eliminateBitsliced(GF28Matrix& m, std::vector<int>& pivots, const SolverOptions& options);
+
+    // Structured elimination (SolverOptions::structured): sparse Markowitz
+    // pivoting first, then the dense core through options.strategy. The pivot
+    // columns follow the Markowitz order, so the result is a reduced form of
+    // the same row space but not necessarily the canonical RREF.
+    int eliminateStructured(GF28Matrix& m, std::vector<int>& pivots, const SolverOptions& options);
+}
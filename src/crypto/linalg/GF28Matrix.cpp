@@ -0,0 +1,190 @@
+#include "GF28Matrix.h"
+#include "Elimination.h"
+#include "../GF/GF28Region.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+int linalg::defaultThreads()
+{
+    const char *env = getenv("WEM_THREADS");
+    return env ? atoi(env) : 1;
+}
+
+GF28Matrix::GF28Matrix(int rows, int cols) { allocate(rows, cols); }
+
+GF28Matrix::~GF28Matrix() { release(); }
+
+GF28Matrix::GF28Matrix(const GF28Matrix& other)
+{
+    *this = other;
+}
+
+GF28Matrix::GF28Matrix(GF28Matrix&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+GF28Matrix& GF28Matrix::operator=(const GF28Matrix& other)
+{
+    if (this == &other) return *this;
+
+    if (nrows != other.nrows || ncols != other.ncols) {
+        release();
+        allocate(other.nrows, other.ncols);
+    }
+    for (int row = 0; row < nrows; ++row)
+        memcpy(rowPtr[row], other.rowPtr[row], stride);
+    pivotCols = other.pivotCols;
+    pivotsAligned = other.pivotsAligned;
+    return *this;
+}
+
+GF28Matrix& GF28Matrix::operator=(GF28Matrix&& other) noexcept
+{
+    if (this == &other) return *this;
+
+    release();
+    std::swap(nrows, other.nrows);
+    std::swap(ncols, other.ncols);
+    std::swap(stride, other.stride);
+    std::swap(storage, other.storage);
+    std::swap(rowPtr, other.rowPtr);
+    std::swap(pivotCols, other.pivotCols);
+    std::swap(pivotsAligned, other.pivotsAligned);
+    return *this;
+}
+
+void GF28Matrix::allocate(int rows, int cols)
+{
+    nrows = rows;
+    ncols = cols;
+    stride = (cols + alignment - 1) / alignment * alignment;
+
+    const size_t size = static_cast<size_t>(rows) * stride;
+    storage = size ? static_cast<byte*>(std::aligned_alloc(alignment, size)) : nullptr;
+    if (size) memset(storage, 0x00, size);
+
+    rowPtr.resize(rows);
+    for (int row = 0; row < rows; ++row)
+        rowPtr[row] = storage + static_cast<size_t>(row) * stride;
+    return;
+}
+
+void GF28Matrix::release()
+{
+    std::free(storage);
+    storage = nullptr;
+    rowPtr.clear();
+    pivotCols.clear();
+    pivotsAligned = false;
+    nrows = ncols = stride = 0;
+    return;
+}
+
+void GF28Matrix::clear()
+{
+    if (storage) memset(storage, 0x00, static_cast<size_t>(nrows) * stride);
+    pivotCols.clear();
+    pivotsAligned = false;
+    return;
+}
+
+void GF28Matrix::swapRows(int row1, int row2)
+{
+    std::swap(rowPtr[row1], rowPtr[row2]);
+    return;
+}
+
+int GF28Matrix::rref(const linalg::SolverOptions& options)
+{
+    pivotCols.clear();
+    pivotsAligned = false;
+    if (options.structured)
+        return linalg::eliminateStructured(*this, pivotCols, options);
+    switch (options.strategy) {
+        case linalg::Strategy::GrayCode:
+            return linalg::eliminateGrayCode(*this, pivotCols, options);
+        case linalg::Strategy::Blocked:
+            return linalg::eliminateBlocked(*this, pivotCols, options);
+        case linalg::Strategy::FourRussians:
+            return linalg::eliminateFourRussians(*this, pivotCols, options);
+        case linalg::Strategy::Bitsliced:
+            return linalg::eliminateBitsliced(*this, pivotCols, options);
+        case linalg::Strategy::Naive:
+        default:
+            return linalg::eliminateNaive(*this, pivotCols, options);
+    }
+}
+
+void GF28Matrix::setPivots(std::vector<int> pivots)
+{
+    assert(static_cast<int>(pivots.size()) <= nrows);
+    assert(std::is_sorted(pivots.begin(), pivots.end()));
+    pivotCols = std::move(pivots);
+    pivotsAligned = false;
+    return;
+}
+
+int GF28Matrix::rank() const
+{
+    GF28Matrix tmp(*this);
+    return tmp.rref();
+}
+
+std::vector< std::vector<unsigned char> > GF28Matrix::nullspace() const
+{
+    const auto basis = nullspaceBasis();
+    std::vector< std::vector<byte> > vectors;
+    for (int i = 0; i < basis.rows(); ++i)
+        vectors.emplace_back(basis[i], basis[i] + ncols);
+    return vectors;
+}
+
+GF28Matrix GF28Matrix::nullspaceBasis() const
+{
+    std::vector<bool> isPivot(ncols, false);
+    for (auto col : pivotCols) isPivot[col] = true;
+
+    GF28Matrix basis(ncols - static_cast<int>(pivotCols.size()), ncols);
+    for (int free = 0, i = 0; free < ncols; ++free) {
+        if (isPivot[free]) continue;
+
+        // x[free] = 1, and each pivot row gives x[pivot] = row[free] (char 2)
+        auto v = basis[i++];
+        v[free] = 0x01;
+        for (size_t r = 0; r < pivotCols.size(); ++r)
+            v[pivotCols[r]] = rowPtr[pivotsAligned ? pivotCols[r] : r][free];
+    }
+    return basis;
+}
+
+void GF28Matrix::combineRows(byte *dst, const byte *coefs) const
+{
+    memset(dst, 0x00, stride);
+    for (int row = 0; row < nrows; ++row)
+        GF28::mulAddRegion(dst, rowPtr[row], coefs[row], stride);
+    return;
+}
+
+void GF28Matrix::alignPivots()
+{
+    assert(nrows >= ncols);
+    const int rank = static_cast<int>(pivotCols.size());
+
+    std::vector<byte*> aligned(nrows, nullptr);
+    for (int i = 0; i < rank; ++i)
+        aligned[pivotCols[i]] = rowPtr[i];
+
+    // rows [rank, nrows) are zero after rref(), use them for the free columns
+    int zeroRow = rank;
+    for (int row = 0; row < nrows; ++row)
+        if (!aligned[row]) aligned[row] = rowPtr[zeroRow++];
+
+    rowPtr.swap(aligned);
+    pivotsAligned = true;
+    return;
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <vector>
+
+namespace linalg {
+    enum class Strategy {
+        Naive,          // Gauss-Jordan, one fused multiply-accumulate per row and pivot
+        GrayCode,       // per-pivot table of all 256 multiples of the pivot row
+        Blocked,        // panels of mutually reduced pivots, one cache-blocked pass per panel
+        FourRussians,   // Blocked panels applied through two 16-entry nibble tables per pivot
+        Bitsliced,      // 8 bit planes per row, multiplies are xors of precomputed plane rows
+    };
+
+    // WEM_THREADS from the environment, 1 when unset; 0 means one per core
+    int defaultThreads();
+
+    struct SolverOptions {
+        Strategy strategy = Strategy::Naive;
+
+        // threads for the row sweeps (OpenMP); results are identical for any count
+        int threads = defaultThreads();
+
+        // sparse Markowitz elimination first, the dense engine only on the core
+        // left over; pivot columns may then differ from the canonical RREF
+        bool structured = false;
+
+        // Naive and GrayCode: leave pivot rows unscaled during the sweep and
+        // fold 1 / pivot into each update coefficient instead; the pivot rows
+        // are normalised in one parallel pass at the end. Same result.
+        bool deferNormalization = false;
+    };
+}
+
+// Dense matrix over GF(2^8). Rows are 64-byte aligned and padded to a
+// multiple of 64 bytes, and are reached through a row-pointer table so a
+// row swap never moves row data.
+class GF28Matrix {
+    using byte = unsigned char;
+
+    private:
+        int nrows = 0;
+        int ncols = 0;
+        int stride = 0;
+        byte *storage = nullptr;
+        std::vector<byte*> rowPtr;
+        std::vector<int> pivotCols;
+        bool pivotsAligned = false;
+
+        void allocate(int rows, int cols);
+        void release();
+
+    public:
+        static constexpr int alignment = 64;
+
+        GF28Matrix() = default;
+        GF28Matrix(int rows, int cols);
+        ~GF28Matrix();
+        GF28Matrix(const GF28Matrix& other);
+        GF28Matrix(GF28Matrix&& other) noexcept;
+        GF28Matrix& operator=(const GF28Matrix& other);
+        GF28Matrix& operator=(GF28Matrix&& other) noexcept;
+
+        int rows() const { return nrows; }
+        int cols() const { return ncols; }
+        int rowStride() const { return stride; }  // padded row length, a multiple of 64
+
+        byte* operator[](int row) { return rowPtr[row]; }
+        const byte* operator[](int row) const { return rowPtr[row]; }
+        byte** rowPointers() { return rowPtr.data(); }
+
+        void clear();
+        void swapRows(int row1, int row2);
+
+        // Gauss-Jordan to reduced row echelon form in place, returns the rank.
+        // Afterwards row i holds the normalised pivot of column pivots()[i],
+        // which is zero in every other pivot column; pivots() is increasing.
+        int rref(const linalg::SolverOptions& options = {});
+        int rank() const;
+
+        const std::vector<int>& pivots() const { return pivotCols; }
+
+        // for rows already in the form rref() leaves them: records pivots as
+        // what rref() would return, without eliminating again
+        void setPivots(std::vector<int> pivots);
+
+        // basis of { x : A x = 0 }, one vector per non-pivot column in column
+        // order, each 1 at its own free column and 0 at the others; needs rref()
+        std::vector< std::vector<byte> > nullspace() const;
+        // the same basis as the rows of a matrix, ready for combineRows()
+        GF28Matrix nullspaceBasis() const;
+
+        // dst = sum_i coefs[i] * row i over all rows(); dst holds rowStride() bytes
+        void combineRows(byte *dst, const byte *coefs) const;
+
+        // after rref(): reorder rows so that row c holds the pivot of column c,
+        // or a zero row when column c has no pivot (needs rows() >= cols())
+        void alignPivots();
+};
+
+template <int Rows, int Cols>
+class FixedGF28Matrix : public GF28Matrix {
+    public:
+        FixedGF28Matrix() : GF28Matrix(Rows, Cols) {}
+};
@@ -0,0 +1,50 @@
+#include "IncrementalSolver.h"
+#include "../GF/GF28.h"
+#include "../GF/GF28Region.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+IncrementalSolver::IncrementalSolver(int cols) : basis(cols, cols), work(1, cols) {}
+
+bool IncrementalSolver::add(const byte *eq)
+{
+    const int len = basis.rowStride();
+    auto row = work[0];
+    memcpy(row, eq, basis.cols());
+
+    // basis rows are zero in each other's pivot columns, so the order is free
+    for (int i = 0; i < rank(); ++i)
+        GF28::mulAddRegion(row, basis[i], row[pivotCols[i]], len);
+
+    int pivot = 0;
+    while (pivot < basis.cols() && !row[pivot]) ++pivot;
+    if (pivot == basis.cols()) return false;
+
+    // the new row leads at pivot, which keeps every basis row in echelon form
+    GF28::mulRegion(row, row, GF28::inv(row[pivot]), len);
+    for (int i = 0; i < rank(); ++i)
+        GF28::mulAddRegion(basis[i], row, basis[i][pivot], len);
+
+    memcpy(basis[rank()], row, len);
+    pivotCols.push_back(pivot);
+    return true;
+}
+
+GF28Matrix IncrementalSolver::reduced() const
+{
+    std::vector< std::pair<int, int> > order;   // (pivot column, basis row)
+    for (int i = 0; i < rank(); ++i) order.push_back({ pivotCols[i], i });
+    std::sort(order.begin(), order.end());
+
+    // the basis is reduced already, sorted by pivot it is the rref
+    GF28Matrix m(cols(), cols());
+    std::vector<int> pivots(rank());
+    for (int i = 0; i < rank(); ++i) {
+        memcpy(m[i], basis[order[i].second], basis.rowStride());
+        pivots[i] = order[i].first;
+    }
+    m.setPivots(std::move(pivots));
+    return m;
+}
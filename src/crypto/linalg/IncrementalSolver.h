@@ -0,0 +1,31 @@
+#pragma once
+
+#include "GF28Matrix.h"
+
+#include <vector>
+
+// Online Gauss-Jordan over GF(2^8). Each equation is reduced against the
+// basis as it arrives, so a driver can stop querying the oracle as soon as
+// the rank it needs is reached instead of collecting a fixed count first.
+class IncrementalSolver {
+    using byte = unsigned char;
+
+    private:
+        GF28Matrix basis;           // rows [0, rank): normalised, zero in every other pivot column
+        std::vector<int> pivotCols; // pivot column of each basis row
+        GF28Matrix work;            // one padded row for the equation being added
+
+    public:
+        explicit IncrementalSolver(int cols);
+
+        int cols() const { return basis.cols(); }
+        int rank() const { return static_cast<int>(pivotCols.size()); }
+
+        // reduces eq (cols() entries) against the basis and keeps the rest;
+        // returns true when eq was independent and the rank grew
+        bool add(const byte *eq);
+
+        // rref of every equation added so far as a cols() x cols() matrix with
+        // pivot bookkeeping, ready for alignPivots() and nullspace()
+        GF28Matrix reduced() const;
+};
@@ -0,0 +1,127 @@
+#include "Elimination.h"
+#include "SparseRow.h"
+#include "../GF/GF28.h"
+#include "../GF/GF28Region.h"
+
+#include <algorithm>
+#include <cstring>
+#include <emmintrin.h>
+#include <vector>
+
+// A fresh attack equation touches at most 8 columns, so the first pivots are
+// much cheaper on sparse rows. Pivots are taken in (approximate) Markowitz
+// order to keep (row weight - 1) * (column count - 1) fill low: the lightest
+// row, on its column with the fewest entries. Each is eliminated from every
+// row. Once the lightest row is no longer sparse, the rows and columns left
+// form a dense core that goes to the dense engine. The sparse pivot rows are
+// then reduced by the core's pivots, and all pivot rows are written back in
+// column order.
+int linalg::eliminateStructured(GF28Matrix& m, std::vector<int>& pivots, const SolverOptions& options)
+{
+    const int rows = m.rows(), cols = m.cols();
+    // row weight beyond which elimination continues dense
+    const int denseWeight = std::max(cols / 128, 16);
+
+    std::vector<SparseRow> sparse(rows);
+    SparseColumns columns(cols);
+    for (int row = 0; row < rows; ++row) {
+        const unsigned char *eq = m[row];
+        // the row stride is a multiple of 16 and the padding is zero
+        for (int base = 0; base < cols; base += 16) {
+            const auto x = _mm_load_si128((const __m128i *)(eq + base));
+            unsigned nonzero = ~_mm_movemask_epi8(_mm_cmpeq_epi8(x, _mm_setzero_si128())) & 0xffff;
+            for (; nonzero; nonzero &= nonzero - 1) {
+                const int col = base + __builtin_ctz(nonzero);
+                sparse[row].push_back({ col, eq[col] });
+                ++columns.count[col];
+                columns.rows[col].push_back(row);
+            }
+        }
+    }
+
+    /**** sparse phase ****/
+    std::vector<char> rowDone(rows, false), colDone(cols, false);
+    std::vector< std::pair<int, int> > sparsePivots;    // (column, row)
+    SparseRow scratch;
+    for (;;) {
+        // lightest active row, then its column with the fewest entries
+        int pivotRow = -1, pivotCol = -1;
+        for (int row = 0; row < rows; ++row) {
+            const int weight = static_cast<int>(sparse[row].size());
+            if (!rowDone[row] && weight > 0 && weight <= denseWeight
+                && (pivotRow < 0 || weight < static_cast<int>(sparse[pivotRow].size())))
+                pivotRow = row;
+        }
+        if (pivotRow < 0) break;
+        // active rows hold no entry in an eliminated column
+        for (const auto& e : sparse[pivotRow])
+            if (pivotCol < 0 || columns.count[e.col] < columns.count[pivotCol])
+                pivotCol = e.col;
+
+        auto& pivot = sparse[pivotRow];
+        const unsigned char inv = GF28::inv(lookup(pivot, pivotCol));
+        for (auto& e : pivot) e.val = GF28::mul(e.val, inv);
+        rowDone[pivotRow] = colDone[pivotCol] = true;
+        sparsePivots.push_back({ pivotCol, pivotRow });
+
+        for (const int row : columns.rows[pivotCol]) {
+            if (row == pivotRow) continue;
+            const unsigned char c = lookup(sparse[row], pivotCol);
+            if (c) axpy(sparse[row], row, pivot, c, columns, scratch);
+        }
+        columns.rows[pivotCol].clear();
+    }
+
+    /**** dense core ****/
+    std::vector<int> coreRows, coreCols, coreIndex(cols, -1);
+    for (int row = 0; row < rows; ++row)
+        if (!rowDone[row] && !sparse[row].empty()) coreRows.push_back(row);
+    for (int col = 0; col < cols; ++col)
+        if (!colDone[col]) {
+            coreIndex[col] = static_cast<int>(coreCols.size());
+            coreCols.push_back(col);
+        }
+
+    GF28Matrix core(static_cast<int>(coreRows.size()), static_cast<int>(coreCols.size()));
+    for (int i = 0; i < core.rows(); ++i)
+        for (const auto& e : sparse[coreRows[i]])
+            core[i][coreIndex[e.col]] = e.val;
+
+    SolverOptions coreOptions = options;
+    coreOptions.structured = false;
+    const int coreRank = core.rows() ? core.rref(coreOptions) : 0;
+
+    /**** write back ****/
+    // every pivot row with its pivot column, sorted by column
+    std::vector< std::pair<int, int> > order;   // (column, core row or -1 - sparse row)
+    for (const auto& p : sparsePivots) order.push_back({ p.first, -1 - p.second });
+    for (int i = 0; i < coreRank; ++i) order.push_back({ coreCols[core.pivots()[i]], i });
+    std::sort(order.begin(), order.end());
+
+    m.clear();
+    std::vector<int> coreSlot(coreRank);
+    for (int slot = 0; slot < static_cast<int>(order.size()); ++slot) {
+        auto eq = m[slot];
+        if (order[slot].second < 0) {
+            for (const auto& e : sparse[-1 - order[slot].second]) eq[e.col] = e.val;
+        } else {
+            const int i = order[slot].second;
+            coreSlot[i] = slot;
+            for (int c = 0; c < core.cols(); ++c) eq[coreCols[c]] = core[i][c];
+        }
+        pivots.push_back(order[slot].first);
+    }
+
+    // the sparse pivot rows still hold entries in core pivot columns; a core
+    // pivot row is zero in every other pivot column, so the order does not matter
+    const int len = m.rowStride();
+    const int threads = teamSize(options.threads);
+    #pragma omp parallel for schedule(static) num_threads(threads) if (threads > 1)
+    for (int slot = 0; slot < static_cast<int>(order.size()); ++slot) {
+        if (order[slot].second >= 0) continue;
+        auto eq = m[slot];
+        for (int i = 0; i < coreRank; ++i)
+            GF28::mulAddRegion(eq, m[coreSlot[i]], eq[coreCols[core.pivots()[i]]], len);
+    }
+    return static_cast<int>(pivots.size());
+}
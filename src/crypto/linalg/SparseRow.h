@@ -0,0 +1,62 @@
+#pragma once
+
+#include "../GF/GF28.h"
+
+#include <algorithm>
+#include <vector>
+
+// Sparse rows of the structured elimination (Sparse.cpp) and of solveSparse
+// (SparseSystem.cpp), internal to linalg: (column, value) entries sorted by
+// column, no zero values.
+namespace linalg {
+    struct SparseEntry {
+        int col;
+        unsigned char val;
+    };
+    using SparseRow = std::vector<SparseEntry>;
+
+    // per column: entries over the active rows, and the rows that gained an
+    // entry there (may hold stale rows)
+    struct SparseColumns {
+        std::vector<int> count;
+        std::vector< std::vector<int> > rows;
+
+        explicit SparseColumns(int cols) : count(cols, 0), rows(cols) {}
+    };
+
+    // value at col, 0 when absent
+    inline unsigned char lookup(const SparseRow& row, int col)
+    {
+        const auto it = std::lower_bound(row.begin(), row.end(), col,
+                                         [](const SparseEntry& e, int c) { return e.col < c; });
+        return (it != row.end() && it->col == col) ? it->val : 0x00;
+    }
+
+    // dst (row number row) ^= c * pivot by merging the two column lists,
+    // keeping cols up to date; scratch is reused across calls
+    inline void axpy(SparseRow& dst, int row, const SparseRow& pivot, unsigned char c, SparseColumns& cols, SparseRow& scratch)
+    {
+        const unsigned char logc = GF28::log03(c);
+        scratch.clear();
+        scratch.reserve(dst.size() + pivot.size());
+        size_t i = 0, j = 0;
+        while (i < dst.size() || j < pivot.size()) {
+            if (j == pivot.size() || (i < dst.size() && dst[i].col < pivot[j].col)) {
+                scratch.push_back(dst[i++]);
+            } else if (i == dst.size() || pivot[j].col < dst[i].col) {
+                const int col = pivot[j].col;
+                scratch.push_back({ col, GF28::mulLog(pivot[j].val, logc) });
+                ++cols.count[col];
+                cols.rows[col].push_back(row);
+                ++j;
+            } else {
+                const unsigned char v = dst[i].val ^ GF28::mulLog(pivot[j].val, logc);
+                if (v) scratch.push_back({ dst[i].col, v });
+                else --cols.count[dst[i].col];
+                ++i, ++j;
+            }
+        }
+        dst.swap(scratch);
+        return;
+    }
+}
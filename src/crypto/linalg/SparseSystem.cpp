@@ -0,0 +1,202 @@
+#include "SparseSystem.h"
+#include "Elimination.h"
+#include "SparseRow.h"
+#include "../GF/GF28.h"
+
+#include <algorithm>
+#include <utility>
+
+SparseSystem::SparseSystem(int cols) : ncols(cols), start(1, 0) {}
+
+bool SparseSystem::add(const int cols[], const byte vals[], int n)
+{
+    std::vector< std::pair<int, byte> > terms;
+    terms.reserve(n);
+    for (int i = 0; i < n; ++i)
+        if (vals[i]) terms.push_back({ cols[i], vals[i] });
+    std::sort(terms.begin(), terms.end());
+
+    const long long first = start.back();
+    for (size_t i = 0; i < terms.size(); ) {
+        const int col = terms[i].first;
+        byte v = 0x00;
+        for (; i < terms.size() && terms[i].first == col; ++i) v ^= terms[i].second;
+        if (!v) continue;
+        colIndex.push_back(col);
+        value.push_back(v);
+    }
+    if (static_cast<long long>(colIndex.size()) == first) return false;
+    start.push_back(static_cast<long long>(colIndex.size()));
+    return true;
+}
+
+void SparseSystem::reserve(long long rows, long long entries)
+{
+    start.reserve(rows + 1);
+    colIndex.reserve(entries);
+    value.reserve(entries);
+    return;
+}
+
+/****************************    solver     ****************************************/
+namespace {
+    using linalg::SparseColumns;
+    using linalg::SparseRow;
+
+    // The active rows of the sparse phase: entries per column over the
+    // active rows, the rows that gained an entry in each column (may hold
+    // stale rows), and the active rows bucketed by weight up to maxWeight
+    // (stale entries are skipped when popped).
+    class ActiveSet {
+        public:
+            std::vector<SparseRow> rows;
+            std::vector<char> done;
+            SparseColumns columns;
+
+            ActiveSet(const SparseSystem& system, int maxWeight)
+                : rows(system.rows()), done(system.rows(), false), columns(system.cols()),
+                  buckets(maxWeight + 1), lowest(maxWeight + 1)
+            {
+                for (int row = 0; row < system.rows(); ++row) {
+                    const int n = system.rowSize(row);
+                    const int *cols = system.rowCols(row);
+                    const unsigned char *vals = system.rowValues(row);
+                    rows[row].reserve(n);
+                    for (int i = 0; i < n; ++i) {
+                        rows[row].push_back({ cols[i], vals[i] });
+                        ++columns.count[cols[i]];
+                        columns.rows[cols[i]].push_back(row);
+                    }
+                    push(row);
+                }
+            }
+
+            void push(int row)
+            {
+                const int weight = static_cast<int>(rows[row].size());
+                if (weight == 0 || weight >= static_cast<int>(buckets.size())) return;
+                buckets[weight].push_back(row);
+                lowest = std::min(lowest, weight);
+                return;
+            }
+
+            // lightest active row within maxWeight, or -1
+            int pop()
+            {
+                for (; lowest < static_cast<int>(buckets.size()); ++lowest) {
+                    auto& bucket = buckets[lowest];
+                    while (!bucket.empty()) {
+                        const int row = bucket.back();
+                        bucket.pop_back();
+                        if (!done[row] && static_cast<int>(rows[row].size()) == lowest) return row;
+                    }
+                }
+                return -1;
+            }
+
+            // rows[row] ^= c * pivot, then rebucketed
+            void axpy(int row, const SparseRow& pivot, unsigned char c)
+            {
+                linalg::axpy(rows[row], row, pivot, c, columns, scratch);
+                push(row);
+                return;
+            }
+
+        private:
+            std::vector< std::vector<int> > buckets;
+            int lowest;
+            SparseRow scratch;
+    };
+}
+
+// A fresh equation of the attacks touches a handful of columns, so pivots
+// are taken sparse first, in (approximate) Markowitz order: the lightest
+// active row, on its column with the fewest active entries. Unlike
+// eliminateStructured() a pivot is only eliminated from the active rows, so
+// the sparse pivot rows stay in echelon form and light; the nullspace is
+// recovered by back substitution in reverse pivot order. Once the lightest
+// row is no longer sparse, the active rows and the columns they touch form a
+// dense core for the (parallel) dense engine.
+int linalg::solveSparse(const SparseSystem& system, std::vector< std::vector<unsigned char> >& kernel,
+                        int maxKernel, const SolverOptions& options)
+{
+    const int cols = system.cols();
+    // row weight beyond which elimination continues dense
+    const int denseWeight = std::max(cols / 128, 16);
+
+    ActiveSet active(system, denseWeight);
+    std::vector<char> colDone(cols, false);
+    std::vector< std::pair<int, int> > sparsePivots;    // (column, row) in elimination order
+
+    /**** sparse phase ****/
+    for (int pivotRow; (pivotRow = active.pop()) >= 0; ) {
+        auto& pivot = active.rows[pivotRow];
+        int pivotCol = -1;
+        for (const auto& e : pivot)
+            if (pivotCol < 0 || active.columns.count[e.col] < active.columns.count[pivotCol])
+                pivotCol = e.col;
+
+        const unsigned char inv = GF28::inv(lookup(pivot, pivotCol));
+        for (auto& e : pivot) {
+            e.val = GF28::mul(e.val, inv);
+            --active.columns.count[e.col];
+        }
+        active.done[pivotRow] = colDone[pivotCol] = true;
+        sparsePivots.push_back({ pivotCol, pivotRow });
+
+        for (const int row : active.columns.rows[pivotCol]) {
+            if (active.done[row]) continue;
+            const unsigned char c = lookup(active.rows[row], pivotCol);
+            if (c) active.axpy(row, pivot, c);
+        }
+        std::vector<int>().swap(active.columns.rows[pivotCol]);
+    }
+
+    /**** dense core ****/
+    std::vector<int> coreRows, coreCols, coreIndex(cols, -1);
+    for (int row = 0; row < system.rows(); ++row)
+        if (!active.done[row] && !active.rows[row].empty()) coreRows.push_back(row);
+    for (int col = 0; col < cols; ++col)
+        if (!colDone[col] && active.columns.count[col] > 0) {
+            coreIndex[col] = static_cast<int>(coreCols.size());
+            coreCols.push_back(col);
+        }
+
+    GF28Matrix core(static_cast<int>(coreRows.size()), static_cast<int>(coreCols.size()));
+    for (int i = 0; i < core.rows(); ++i) {
+        for (const auto& e : active.rows[coreRows[i]]) core[i][coreIndex[e.col]] = e.val;
+        SparseRow().swap(active.rows[coreRows[i]]);
+    }
+
+    SolverOptions coreOptions = options;
+    coreOptions.structured = false;
+    const int coreRank = core.rows() ? core.rref(coreOptions) : 0;
+    for (int i = 0; i < coreRank; ++i) colDone[coreCols[core.pivots()[i]]] = true;
+
+    /**** back substitution ****/
+    std::vector<int> freeCols;
+    for (int col = 0; col < cols && static_cast<int>(freeCols.size()) < maxKernel; ++col)
+        if (!colDone[col]) freeCols.push_back(col);
+
+    kernel.assign(freeCols.size(), std::vector<unsigned char>(cols, 0x00));
+    const int threads = teamSize(options.threads);
+    #pragma omp parallel for schedule(dynamic, 1) num_threads(threads) if (threads > 1)
+    for (int k = 0; k < static_cast<int>(freeCols.size()); ++k) {
+        auto& x = kernel[k];
+        const int f = freeCols[k];
+        x[f] = 0x01;
+
+        // core pivot row i reads x_p + sum_j core[i][j] x_j = 0 over its free columns
+        if (coreIndex[f] >= 0)
+            for (int i = 0; i < coreRank; ++i)
+                x[coreCols[core.pivots()[i]]] = core[i][coreIndex[f]];
+
+        for (auto it = sparsePivots.rbegin(); it != sparsePivots.rend(); ++it) {
+            unsigned char v = 0x00;
+            for (const auto& e : active.rows[it->second])
+                if (e.col != it->first) v ^= GF28::mul(e.val, x[e.col]);
+            x[it->first] = v;
+        }
+    }
+    return static_cast<int>(sparsePivots.size()) + coreRank;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "GF28Matrix.h"
+
+#include <vector>
+
+// Homogeneous linear system over GF(2^8) in compressed rows, for systems too
+// wide to store densely (the 16-bit S-box attack has 2^17 unknowns). A row
+// costs 5 bytes per non-zero, so equations can be streamed in straight from
+// the oracle.
+class SparseSystem {
+    using byte = unsigned char;
+
+    private:
+        int ncols;
+        std::vector<long long> start;   // row i is [start[i], start[i + 1])
+        std::vector<int> colIndex;
+        std::vector<byte> value;
+
+    public:
+        explicit SparseSystem(int cols);
+
+        int rows() const { return static_cast<int>(start.size()) - 1; }
+        int cols() const { return ncols; }
+        long long entries() const { return start.back(); }
+
+        // appends sum_i vals[i] * x[cols[i]] = 0; repeated columns are added
+        // up and zero terms dropped. Returns false for an all-zero equation.
+        bool add(const int cols[], const byte vals[], int n);
+
+        int rowSize(int row) const { return static_cast<int>(start[row + 1] - start[row]); }
+        const int* rowCols(int row) const { return colIndex.data() + start[row]; }
+        const byte* rowValues(int row) const { return value.data() + start[row]; }
+
+        void reserve(long long rows, long long entries);
+};
+
+namespace linalg {
+    // Rank and nullspace of a sparse system: sparse Markowitz elimination to
+    // echelon form while the rows stay light, options.strategy on the dense
+    // core left over (options.threads), then back substitution. kernel gets up
+    // to maxKernel basis vectors of cols() bytes, each 1 at its own free column
+    // and 0 at the other free columns. Returns the rank.
+    int solveSparse(const SparseSystem& system, std::vector< std::vector<unsigned char> >& kernel,
+                    int maxKernel, const SolverOptions& options = {});
+}
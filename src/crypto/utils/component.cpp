@@ -1,12 +1,15 @@
 #include "component.h"
 
 #include "../AES/AES128_ni.h"
+#include "../AES/AESCTR.h"
+#include "../AES/AESRound.h"
 #include "../GF/GF28.h"
+#include "slayer.h"
 
 #include <iostream>
 #include <iomanip>
 #include <cstring>
-#include <wmmintrin.h>
+#include <emmintrin.h>
 #include <array>
 
 /*
@@ -67,37 +70,25 @@ void component::printx(const unsigned char s[16])
 
 void component::invSB(unsigned char text[16])
 {
-    unsigned char tmp[16];
-    for (int i = 0; i < 16; ++i)
-        tmp[i] = aesInvSbox[text[i]];
-    memcpy(text, tmp, 16);
+    slayer::substitute(text, aesInvSbox.data());
     return;
 }
 
 void component::SB(unsigned char text[16])
 {
-    unsigned char tmp[16];
-    for (int i = 0; i < 16; ++i)
-        tmp[i] = aesSbox[text[i]];
-    memcpy(text, tmp, 16);
+    slayer::substitute(text, aesSbox.data());
     return;
 }
 
 void component::SB(unsigned char text[16], const unsigned char sbox[256])
 {
-    unsigned char tmp[16];
-    for (int i = 0; i < 16; ++i)
-        tmp[i] = sbox[text[i]];
-    memcpy(text, tmp, 16);
+    slayer::substitute(text, sbox);
     return;
 }
 
 void component::SB(unsigned char text[16], const std::array<unsigned char, 256>& sbox)
 {
-    unsigned char tmp[16];
-    for (int i = 0; i < 16; ++i)
-        tmp[i] = sbox[text[i]];
-    memcpy(text, tmp, 16);
+    slayer::substitute(text, sbox.data());
     return;
 }
 
@@ -167,91 +158,45 @@ void component::invSR(unsigned char text[16])
     return;
 }
 
-inline void generateRndStream(unsigned char rndStream[256 * 16 * 3], unsigned char key[16], int rndIndex = 0)
-{
-    AESKey aesKey(key);
-    AES& aesHandler = AES::instance();
-    unsigned char counter[16];
-    memset(counter, 0x00, 16);
-    for (int i = rndIndex; i < 256 * 3; ++i) {
-        counter[14] = (i >> 8) & 0xff;
-        counter[15] = i & 0xff;
-
-        aesHandler.AESEncrypt(rndStream, counter, aesKey, 10);
-
-        rndStream += 16;
-    }
-    return;
-}
-int component::generateBox(unsigned char sbox[256], unsigned char invsbox[256], unsigned char key[16], int rndIndex)
+void component::generateBox(unsigned char sbox[256], unsigned char invsbox[256], AESCTR& rng)
 {
-    unsigned char rndStream[256 * 16 * 3];
-    generateRndStream(rndStream, key);
-
     for (int i = 0; i < 256; ++i) sbox[i] = i;
-    for (int i = 256 - 1; i >= 0; --i) {
-        int j = rndStream[rndIndex++] % (i + 1);
-        int tmp = sbox[i];
-        sbox[i] = sbox[j];
-        sbox[j] = tmp;
-    }
+    rng.shuffle(sbox, 256);
 
     for (int i = 0; i < 256; ++i)
         invsbox[sbox[i]] = i;
-
-    return rndIndex;
+    return;
 }
 
-int component::generateBox16(unsigned short sbox[1 << 16], unsigned short invsbox[1 << 16], unsigned char key[16], int rndIndex)
+void component::generateBox(unsigned char sbox[256], unsigned char invsbox[256], const unsigned char key[16])
 {
-    unsigned char _rndStream[256 * 16 * 3];
-    generateRndStream(_rndStream, key);
-    auto rndStream = reinterpret_cast<unsigned short*>(_rndStream);
+    AESCTR rng(key);
+    generateBox(sbox, invsbox, rng);
+    return;
+}
 
+void component::generateBox16(unsigned short sbox[1 << 16], unsigned short invsbox[1 << 16], AESCTR& rng)
+{
     for (int i = 0; i < (1 << 16); ++i) sbox[i] = i;
-    for (int i = (1 << 16) - 1; i >= 0; --i) {
-        int j = rndStream[rndIndex++] % (i + 1);
-        int tmp = sbox[i];
-        sbox[i] = sbox[j];
-        sbox[j] = tmp;
-
-        if (rndIndex % 256 == 0) {
-            generateRndStream(_rndStream, key, i);
-            rndIndex = 0;
-        }
-    }
+    rng.shuffle(sbox, 1 << 16);
 
     for (int i = 0; i < (1 << 16); ++i)
         invsbox[sbox[i]] = i;
-
-    return rndIndex;
+    return;
 }
 
-#define AES_128_key_exp(k, rcon) aes_128_key_expansion(k, _mm_aeskeygenassist_si128(k, rcon))
-inline __m128i aes_128_key_expansion(__m128i key, __m128i keygened)
+void component::generateBox16(unsigned short sbox[1 << 16], unsigned short invsbox[1 << 16], const unsigned char key[16])
 {
-    keygened = _mm_shuffle_epi32(keygened, _MM_SHUFFLE(3,3,3,3));
-    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
-    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
-    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
-    return _mm_xor_si128(key, keygened);
+    AESCTR rng(key);
+    generateBox16(sbox, invsbox, rng);
+    return;
 }
+
 void component::generateAESRoundKey(unsigned char roundkey[11][16], unsigned char key[16])
 {
     __m128i rk[11];
 
-    rk[0] = _mm_loadu_si128((const __m128i*)key);
-
-    rk[1]  = AES_128_key_exp(rk[0], 0x01);
-    rk[2]  = AES_128_key_exp(rk[1], 0x02);
-    rk[3]  = AES_128_key_exp(rk[2], 0x04);
-    rk[4]  = AES_128_key_exp(rk[3], 0x08);
-    rk[5]  = AES_128_key_exp(rk[4], 0x10);
-    rk[6]  = AES_128_key_exp(rk[5], 0x20);
-    rk[7]  = AES_128_key_exp(rk[6], 0x40);
-    rk[8]  = AES_128_key_exp(rk[7], 0x80);
-    rk[9]  = AES_128_key_exp(rk[8], 0x1B);
-    rk[10] = AES_128_key_exp(rk[9], 0x36);
+    AESRound::ops().expandKey(rk, key);
 
     for (int i = 0; i < 11; ++i)
         _mm_storeu_si128((__m128i *)roundkey[i], rk[i]);
@@ -1,5 +1,9 @@
+#pragma once
+
 #include <array>
 
+class AESCTR;
+
 namespace component {
     void SB(unsigned char text[16], const std::array<unsigned char, 256>& sbox);
     void SB(unsigned char text[16], const unsigned char sbox[256]);
@@ -16,8 +20,12 @@ namespace component {
 
     void invSR(unsigned char text[16]);
 
-    int generateBox(unsigned char sbox[256], unsigned char invsbox[256], unsigned char key[16], int rndIndex = 0);
-    int generateBox16(unsigned short sbox[1 << 16], unsigned short invsbox[1 << 16], unsigned char key[16], int rndIndex = 0);
+    // random permutations, Fisher-Yates over the AES-CTR stream of key; the
+    // AESCTR overloads continue a stream, so several boxes can share one key
+    void generateBox(unsigned char sbox[256], unsigned char invsbox[256], const unsigned char key[16]);
+    void generateBox(unsigned char sbox[256], unsigned char invsbox[256], AESCTR& rng);
+    void generateBox16(unsigned short sbox[1 << 16], unsigned short invsbox[1 << 16], const unsigned char key[16]);
+    void generateBox16(unsigned short sbox[1 << 16], unsigned short invsbox[1 << 16], AESCTR& rng);
 
     void generateAESRoundKey(unsigned char roundKey[11][16], unsigned char key[16]);
 
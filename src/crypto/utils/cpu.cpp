@@ -0,0 +1,86 @@
+#include "cpu.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+struct Features {
+    cpu::Tier tier;
+    bool aesni;
+    bool vaes;
+    bool vbmi;
+};
+
+static cpu::Tier parseTier(const char *s, cpu::Tier fallback)
+{
+    for (int t = cpu::Scalar; t <= cpu::GFNI; ++t)
+        if (strcmp(s, cpu::tierName(static_cast<cpu::Tier>(t))) == 0)
+            return static_cast<cpu::Tier>(t);
+
+    std::cerr << "WEM_CPU_TIER: unknown tier '" << s << "', using " << cpu::tierName(fallback) << std::endl;
+    return fallback;
+}
+
+static Features detect()
+{
+    __builtin_cpu_init();
+
+    cpu::Tier best = cpu::Scalar;
+    if (__builtin_cpu_supports("ssse3")) best = cpu::SSSE3;
+    if (best == cpu::SSSE3 && __builtin_cpu_supports("avx2")) best = cpu::AVX2;
+    if (best == cpu::AVX2 && __builtin_cpu_supports("avx512bw")) best = cpu::AVX512BW;
+    if (best == cpu::AVX512BW && __builtin_cpu_supports("gfni")) best = cpu::GFNI;
+
+    Features f;
+    f.tier = best;
+    if (const char *env = getenv("WEM_CPU_TIER")) {
+        const auto forced = parseTier(env, best);
+        if (forced > best)
+            std::cerr << "WEM_CPU_TIER: " << env << " not supported, using " << cpu::tierName(best) << std::endl;
+        else
+            f.tier = forced;
+    }
+
+    f.aesni = f.tier > cpu::Scalar && __builtin_cpu_supports("aes");
+    f.vaes = f.aesni && f.tier >= cpu::AVX2 && __builtin_cpu_supports("vaes");
+    f.vbmi = f.tier >= cpu::AVX512BW && __builtin_cpu_supports("avx512vbmi");
+    return f;
+}
+
+static const Features& features()
+{
+    static const Features f = detect();
+    return f;
+}
+
+cpu::Tier cpu::tier()
+{
+    return features().tier;
+}
+
+bool cpu::hasAESNI()
+{
+    return features().aesni;
+}
+
+bool cpu::hasVAES()
+{
+    return features().vaes;
+}
+
+bool cpu::hasVBMI()
+{
+    return features().vbmi;
+}
+
+const char* cpu::tierName(Tier t)
+{
+    switch (t) {
+        case Scalar:   return "scalar";
+        case SSSE3:    return "ssse3";
+        case AVX2:     return "avx2";
+        case AVX512BW: return "avx512bw";
+        case GFNI:     return "gfni";
+    }
+    return "unknown";
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+// Runtime CPU feature detection; the hot kernels bind their implementation
+// once from these answers. WEM_CPU_TIER=scalar|ssse3|avx2|avx512bw|gfni
+// caps the tier (and disables AES-NI when set to scalar) for A/B runs.
+namespace cpu {
+    enum Tier {
+        Scalar = 0,
+        SSSE3,
+        AVX2,
+        AVX512BW,
+        GFNI,       // AVX512BW + GF2P8MULB
+    };
+
+    Tier tier();
+
+    bool hasAESNI();
+    bool hasVAES();     // VAES on 256-bit lanes (AVX2 tier or above)
+    bool hasVBMI();     // AVX512_VBMI (vpermi2b), AVX512BW tier or above
+
+    const char* tierName(Tier t);
+}
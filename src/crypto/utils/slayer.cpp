@@ -0,0 +1,243 @@
+#include "slayer.h"
+#include "cpu.h"
+
+#include <cstring>
+#include <immintrin.h>
+
+// The SIMD kernels read the table as 16 rows of 16 bytes, row k serving the
+// bytes whose high nibble is k: one PSHUFB by the low nibbles per row, kept
+// where the high nibble matches. A register of 2 or 4 lanes holds as many
+// consecutive rows, so the table needs no reordering, only its 64-byte
+// alignment (see WEMKey) for the wide loads.
+
+/****************************    scalar     ****************************************/
+static void substituteBytesScalar(unsigned char *data, int len, const unsigned char table[256])
+{
+    for (int i = 0; i < len; ++i)
+        data[i] = table[data[i]];
+    return;
+}
+
+static void substituteScalar(unsigned char text[16], const unsigned char table[256])
+{
+    unsigned char tmp[16];
+    for (int i = 0; i < 16; ++i)
+        tmp[i] = table[text[i]];
+    memcpy(text, tmp, 16);
+    return;
+}
+
+/****************************    SSSE3     ****************************************/
+__attribute__((target("ssse3")))
+static inline __m128i lookupSSSE3(__m128i x, const unsigned char table[256])
+{
+    const auto mask = _mm_set1_epi8(0x0f);
+    const auto lo = _mm_and_si128(x, mask);
+    const auto hi = _mm_and_si128(_mm_srli_epi64(x, 4), mask);
+
+    auto r = _mm_setzero_si128();
+    for (int k = 0; k < 16; ++k) {
+        const auto row = _mm_loadu_si128((const __m128i *)(table + 16 * k));
+        const auto sel = _mm_cmpeq_epi8(hi, _mm_set1_epi8(static_cast<char>(k)));
+        r = _mm_or_si128(r, _mm_and_si128(sel, _mm_shuffle_epi8(row, lo)));
+    }
+    return r;
+}
+
+__attribute__((target("ssse3")))
+static void substituteSSSE3(unsigned char text[16], const unsigned char table[256])
+{
+    const auto x = _mm_loadu_si128((const __m128i *)text);
+    _mm_storeu_si128((__m128i *)text, lookupSSSE3(x, table));
+    return;
+}
+
+__attribute__((target("ssse3")))
+static void substituteBytesSSSE3(unsigned char *data, int len, const unsigned char table[256])
+{
+    int i = 0;
+    for (; i + 16 <= len; i += 16)
+        substituteSSSE3(data + i, table);
+    substituteBytesScalar(data + i, len - i, table);
+    return;
+}
+
+/****************************    AVX2     ****************************************/
+// one block: the block in both lanes, lane l serving rows 2j + l, 8 steps
+__attribute__((target("avx2")))
+static void substituteAVX2(unsigned char text[16], const unsigned char table[256])
+{
+    const auto x = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)text));
+    const auto mask = _mm256_set1_epi8(0x0f);
+    const auto lo = _mm256_and_si256(x, mask);
+    const auto hi = _mm256_and_si256(_mm256_srli_epi64(x, 4), mask);
+
+    auto key = _mm256_setr_m128i(_mm_set1_epi8(0), _mm_set1_epi8(1));
+    auto r = _mm256_setzero_si256();
+    for (int j = 0; j < 8; ++j) {
+        const auto rows = _mm256_loadu_si256((const __m256i *)(table + 32 * j));
+        const auto sel = _mm256_cmpeq_epi8(hi, key);
+        r = _mm256_or_si256(r, _mm256_and_si256(sel, _mm256_shuffle_epi8(rows, lo)));
+        key = _mm256_add_epi8(key, _mm256_set1_epi8(2));
+    }
+
+    const auto y = _mm_or_si128(_mm256_castsi256_si128(r), _mm256_extracti128_si256(r, 1));
+    _mm_storeu_si128((__m128i *)text, y);
+    return;
+}
+
+// bulk: 32 bytes per step, every row broadcast to both lanes
+__attribute__((target("avx2")))
+static void substituteBytesAVX2(unsigned char *data, int len, const unsigned char table[256])
+{
+    const auto mask = _mm256_set1_epi8(0x0f);
+    int i = 0;
+    for (; i + 32 <= len; i += 32) {
+        const auto x = _mm256_loadu_si256((const __m256i *)(data + i));
+        const auto lo = _mm256_and_si256(x, mask);
+        const auto hi = _mm256_and_si256(_mm256_srli_epi64(x, 4), mask);
+
+        auto r = _mm256_setzero_si256();
+        for (int k = 0; k < 16; ++k) {
+            const auto row = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)(table + 16 * k)));
+            const auto sel = _mm256_cmpeq_epi8(hi, _mm256_set1_epi8(static_cast<char>(k)));
+            r = _mm256_or_si256(r, _mm256_and_si256(sel, _mm256_shuffle_epi8(row, lo)));
+        }
+        _mm256_storeu_si256((__m256i *)(data + i), r);
+    }
+    for (; i + 16 <= len; i += 16)
+        substituteAVX2(data + i, table);
+    substituteBytesScalar(data + i, len - i, table);
+    return;
+}
+
+/****************************    AVX512BW     ****************************************/
+// The broadcasts, shifts and extracts use the maskz forms under a full mask:
+// GCC's plain forms merge into an undefined register, which -Wuninitialized
+// reports, and the full mask compiles to the same instructions.
+constexpr __mmask8 all8 = 0xff;
+constexpr __mmask16 all16 = 0xffff;
+
+// one block: the block in all four lanes, lane l serving rows 4j + l, 4 steps
+__attribute__((target("avx512f,avx512bw")))
+static void substituteAVX512(unsigned char text[16], const unsigned char table[256])
+{
+    const auto x = _mm512_maskz_broadcast_i32x4(all16, _mm_loadu_si128((const __m128i *)text));
+    const auto mask = _mm512_set1_epi8(0x0f);
+    const auto lo = _mm512_and_si512(x, mask);
+    const auto hi = _mm512_and_si512(_mm512_maskz_srli_epi64(all8, x, 4), mask);
+
+    auto key = _mm512_set_epi32(0x03030303, 0x03030303, 0x03030303, 0x03030303, 0x02020202, 0x02020202, 0x02020202, 0x02020202,
+                                0x01010101, 0x01010101, 0x01010101, 0x01010101, 0, 0, 0, 0);
+    auto r = _mm512_setzero_si512();
+    for (int j = 0; j < 4; ++j) {
+        const auto rows = _mm512_loadu_si512((const void *)(table + 64 * j));
+        const auto sel = _mm512_cmpeq_epi8_mask(hi, key);
+        r = _mm512_mask_shuffle_epi8(r, sel, rows, lo);
+        key = _mm512_add_epi8(key, _mm512_set1_epi8(4));
+    }
+
+    const auto r256 = _mm256_or_si256(_mm512_maskz_extracti64x4_epi64(all8, r, 0), _mm512_maskz_extracti64x4_epi64(all8, r, 1));
+    const auto y = _mm_or_si128(_mm256_castsi256_si128(r256), _mm256_extracti128_si256(r256, 1));
+    _mm_storeu_si128((__m128i *)text, y);
+    return;
+}
+
+// bulk: 64 bytes per step, every row broadcast to all lanes
+__attribute__((target("avx512f,avx512bw")))
+static void substituteBytesAVX512(unsigned char *data, int len, const unsigned char table[256])
+{
+    const auto mask = _mm512_set1_epi8(0x0f);
+    int i = 0;
+    for (; i + 64 <= len; i += 64) {
+        const auto x = _mm512_loadu_si512((const void *)(data + i));
+        const auto lo = _mm512_and_si512(x, mask);
+        const auto hi = _mm512_and_si512(_mm512_maskz_srli_epi64(all8, x, 4), mask);
+
+        auto r = _mm512_setzero_si512();
+        for (int k = 0; k < 16; ++k) {
+            const auto row = _mm512_maskz_broadcast_i32x4(all16, _mm_loadu_si128((const __m128i *)(table + 16 * k)));
+            const auto sel = _mm512_cmpeq_epi8_mask(hi, _mm512_set1_epi8(static_cast<char>(k)));
+            r = _mm512_mask_shuffle_epi8(r, sel, row, lo);
+        }
+        _mm512_storeu_si512((void *)(data + i), r);
+    }
+    for (; i + 16 <= len; i += 16)
+        substituteAVX512(data + i, table);
+    substituteBytesScalar(data + i, len - i, table);
+    return;
+}
+
+/****************************    AVX512 VBMI     ****************************************/
+// vpermi2b looks up 128 entries from two registers: one lookup per table
+// half, then bit 7 of the index picks the half
+__attribute__((target("avx512f,avx512bw,avx512vbmi")))
+static inline __m512i lookupVBMI(__m512i x, const __m512i t[4])
+{
+    const auto a = _mm512_permutex2var_epi8(t[0], x, t[1]);
+    const auto b = _mm512_permutex2var_epi8(t[2], x, t[3]);
+    return _mm512_mask_blend_epi8(_mm512_movepi8_mask(x), a, b);
+}
+
+__attribute__((target("avx512f,avx512bw,avx512vbmi")))
+static void substituteBytesVBMI(unsigned char *data, int len, const unsigned char table[256])
+{
+    __m512i t[4];
+    for (int j = 0; j < 4; ++j) t[j] = _mm512_loadu_si512((const void *)(table + 64 * j));
+
+    int i = 0;
+    for (; i + 64 <= len; i += 64) {
+        const auto x = _mm512_loadu_si512((const void *)(data + i));
+        _mm512_storeu_si512((void *)(data + i), lookupVBMI(x, t));
+    }
+    if (i < len) {
+        const __mmask64 tail = ~0ull >> (64 - (len - i));
+        const auto x = _mm512_maskz_loadu_epi8(tail, data + i);
+        _mm512_mask_storeu_epi8(data + i, tail, lookupVBMI(x, t));
+    }
+    return;
+}
+
+__attribute__((target("avx512f,avx512bw,avx512vbmi")))
+static void substituteVBMI(unsigned char text[16], const unsigned char table[256])
+{
+    __m512i t[4];
+    for (int j = 0; j < 4; ++j) t[j] = _mm512_loadu_si512((const void *)(table + 64 * j));
+
+    const auto x = _mm512_maskz_loadu_epi8(0xffff, text);
+    _mm512_mask_storeu_epi8(text, 0xffff, lookupVBMI(x, t));
+    return;
+}
+
+/****************************    dispatch     ****************************************/
+struct SLayerKernels {
+    void (*substitute)(unsigned char text[16], const unsigned char table[256]);
+    void (*substituteBytes)(unsigned char *data, int len, const unsigned char table[256]);
+};
+
+static SLayerKernels bindKernels()
+{
+    if (cpu::hasVBMI()) return { substituteVBMI, substituteBytesVBMI };
+    if (cpu::tier() >= cpu::AVX512BW) return { substituteAVX512, substituteBytesAVX512 };
+    if (cpu::tier() >= cpu::AVX2) return { substituteAVX2, substituteBytesAVX2 };
+    if (cpu::tier() >= cpu::SSSE3) return { substituteSSSE3, substituteBytesSSSE3 };
+    return { substituteScalar, substituteBytesScalar };
+}
+
+static const SLayerKernels& kernels()
+{
+    static const SLayerKernels k = bindKernels();
+    return k;
+}
+
+void slayer::substitute(unsigned char text[16], const unsigned char table[256])
+{
+    kernels().substitute(text, table);
+    return;
+}
+
+void slayer::substituteBytes(unsigned char *data, int len, const unsigned char table[256])
+{
+    kernels().substituteBytes(data, len, table);
+    return;
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+// S-layer lookups text[i] = table[text[i]] for an arbitrary (key-dependent)
+// 256-entry table, bound at startup per utils/cpu.h: 16-row PSHUFB on
+// SSSE3 / AVX2 / AVX512BW, vpermi2b on AVX-512 VBMI
+namespace slayer {
+    void substitute(unsigned char text[16], const unsigned char table[256]);
+    // any number of bytes, up to 64 per instruction sequence
+    void substituteBytes(unsigned char *data, int len, const unsigned char table[256]);
+}
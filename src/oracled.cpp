@@ -0,0 +1,298 @@
+#include "WEM/WEM_2EM.hpp"
+#include "WEM/OracleProtocol.h"
+#include "WEM/SuperSbox.h"
+#include "utils/component.h"
+
+#include <iostream>
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <deque>
+#include <chrono>
+#include <utility>
+#include <poll.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using std::cout;
+using std::endl;
+
+using namespace oracleProtocol;
+using Clock = std::chrono::steady_clock;
+
+// Oracle server: the stand-in for a remote encryption / decryption oracle.
+// It answers one client at a time on a Unix domain socket (OracleProtocol.h)
+// with the cipher and key the client sets up, WEM<P1, P2> for P1, P2 up to
+// maxRounds or the supersbox oracle. Each reply leaves latency after its
+// request arrived, independently of the others, so pipelined requests
+// overlap as they would on a network link. Blocks are counted per client.
+//   oracled [--socket PATH] [--latency-us N]
+// The clients (RemoteOracle) find the socket through WEM_ORACLE, which is
+// also the default PATH here (else /tmp/wem-oracle.sock).
+
+/****************************    hosted ciphers     ****************************************/
+using BatchFn = void (*)(unsigned char out[], const unsigned char in[], int n, const WEMKey& key);
+
+struct WEMEntry {
+    BatchFn encrypt;
+    BatchFn decrypt;
+};
+
+template <int P1, int P2>
+static void encryptWEM(unsigned char out[], const unsigned char in[], int n, const WEMKey& key)
+{
+    WEM<P1, P2>::instance().WEMEncryptBatch(out, in, n, key);
+    return;
+}
+
+template <int P1, int P2>
+static void decryptWEM(unsigned char out[], const unsigned char in[], int n, const WEMKey& key)
+{
+    WEM<P1, P2>::instance().WEMDecryptBatch(out, in, n, key);
+    return;
+}
+
+template <int P1, int... P2>
+static void fillRow(WEMEntry row[], std::integer_sequence<int, P2...>)
+{
+    ((row[P2 + 1] = { encryptWEM<P1, P2 + 1>, decryptWEM<P1, P2 + 1> }), ...);
+    return;
+}
+
+template <int... P1>
+static void fillTable(WEMEntry table[][maxRounds + 1], std::integer_sequence<int, P1...>)
+{
+    (fillRow<P1 + 1>(table[P1 + 1], std::make_integer_sequence<int, maxRounds>()), ...);
+    return;
+}
+
+// WEM<p1, p2> for p1, p2 in [1, maxRounds]
+static const WEMEntry& wemEntry(int p1, int p2)
+{
+    struct Table {
+        WEMEntry rows[maxRounds + 1][maxRounds + 1] = {};
+        Table() { fillTable(rows, std::make_integer_sequence<int, maxRounds>()); }
+    };
+    static const Table table;
+    return table.rows[p1][p2];
+}
+
+class Host {
+    using byte = unsigned char;
+
+    private:
+        uint32_t cipher = 0;
+        WEMKey key;
+        WEMEntry wem = {};
+        byte mat[32][4];
+        byte ssb[256];
+        byte invssb[256];
+
+    public:
+        bool setup(const SetupRequest& request)
+        {
+            cipher = 0;
+            if (request.cipher == WEMCipher) {
+                if (request.p1 < 1 || request.p1 > maxRounds || request.p2 < 1 || request.p2 > maxRounds) return false;
+                byte k[16];
+                memcpy(k, request.key, 16);
+                key = WEMKey(k);
+                wem = wemEntry(request.p1, request.p2);
+            } else if (request.cipher == SuperSboxCipher) {
+                memcpy(mat, request.mat, sizeof(mat));
+                component::generateBox(ssb, invssb, request.key);
+            } else {
+                return false;
+            }
+            cipher = request.cipher;
+            return true;
+        }
+
+        bool ready() const { return cipher != 0; }
+        int blockBytes() const { return blockSize(cipher); }
+
+        bool answer(uint32_t op, byte out[], const byte in[], int n)
+        {
+            if (cipher == WEMCipher) {
+                (op == Encrypt ? wem.encrypt : wem.decrypt)(out, in, n, key);
+                return true;
+            }
+            if (cipher == SuperSboxCipher && op == Decrypt) {
+                superSbox::decrypt(reinterpret_cast<byte (*)[4]>(out), reinterpret_cast<const byte (*)[4]>(in), n, mat, invssb);
+                return true;
+            }
+            return false;
+        }
+};
+
+/****************************    connection     ****************************************/
+struct Reply {
+    Clock::time_point due;
+    std::vector<unsigned char> data;
+    size_t offset;
+};
+
+// answers the request at the front of in[0, len) and sets used to its size,
+// 0 while it is incomplete; false drops the client
+static bool handle(Host& host, StatsReply& stats, const unsigned char *in, size_t len, Reply& reply, size_t& used)
+{
+    used = 0;
+    if (len < sizeof(Header)) return true;
+    Header header;
+    memcpy(&header, in, sizeof(header));
+
+    size_t payload = 0;
+    if (header.op == Setup) payload = sizeof(SetupRequest);
+    else if (header.op == Encrypt || header.op == Decrypt) {
+        if (!host.ready() || header.count > maxCount) return false;
+        payload = static_cast<size_t>(header.count) * host.blockBytes();
+    } else if (header.op != Stats) {
+        return false;
+    }
+    if (len < sizeof(header) + payload) return true;
+    used = sizeof(header) + payload;
+    in += sizeof(header);
+    ++stats.messages;
+
+    Header answer = { header.op, 0 };
+    reply.data.assign(sizeof(answer), 0);
+    if (header.op == Setup) {
+        SetupRequest request;
+        memcpy(&request, in, sizeof(request));
+        if (!host.setup(request)) answer.op = Error;
+    } else if (header.op == Stats) {
+        reply.data.resize(sizeof(answer) + sizeof(stats));
+        memcpy(reply.data.data() + sizeof(answer), &stats, sizeof(stats));
+    } else {
+        answer.count = header.count;
+        reply.data.resize(sizeof(answer) + payload);
+        if (host.answer(header.op, reply.data.data() + sizeof(answer), in, header.count)) {
+            (header.op == Encrypt ? stats.encrypted : stats.decrypted) += header.count;
+        } else {
+            answer = { Error, 0 };
+            reply.data.resize(sizeof(answer));
+        }
+    }
+    memcpy(reply.data.data(), &answer, sizeof(answer));
+    return true;
+}
+
+static void serve(int fd, Clock::duration latency, int client)
+{
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+    Host host;
+    StatsReply stats = {};
+    std::vector<unsigned char> in;
+    std::deque<Reply> out;
+    std::vector<unsigned char> buffer(1 << 16);
+
+    for (bool open = true; open || !out.empty(); ) {
+        const auto now = Clock::now();
+        const bool due = !out.empty() && out.front().due <= now;
+
+        pollfd p = { fd, static_cast<short>((open ? POLLIN : 0) | (due ? POLLOUT : 0)), 0 };
+        timespec wait, *timeout = nullptr;
+        if (!out.empty() && !due) {
+            const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(out.front().due - now).count();
+            wait = { static_cast<time_t>(ns / 1000000000), static_cast<long>(ns % 1000000000) };
+            timeout = &wait;
+        }
+        if (ppoll(&p, 1, timeout, nullptr) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (p.revents & POLLERR) break;
+
+        if (open && (p.revents & (POLLIN | POLLHUP))) {
+            const ssize_t n = read(fd, buffer.data(), buffer.size());
+            if (n == 0) open = false;
+            else if (n < 0 && errno != EAGAIN && errno != EINTR) break;
+            else if (n > 0) {
+                const auto arrival = Clock::now();
+                in.insert(in.end(), buffer.begin(), buffer.begin() + n);
+                size_t head = 0, used;
+                for (;;) {
+                    Reply reply = { arrival + latency, {}, 0 };
+                    if (!handle(host, stats, in.data() + head, in.size() - head, reply, used)) {
+                        open = false;
+                        out.clear();
+                        break;
+                    }
+                    if (used == 0) break;
+                    head += used;
+                    out.push_back(std::move(reply));
+                }
+                in.erase(in.begin(), in.begin() + std::min(head, in.size()));
+            }
+        }
+
+        bool broken = false;
+        while (!out.empty() && out.front().due <= Clock::now()) {
+            auto& reply = out.front();
+            const ssize_t n = write(fd, reply.data.data() + reply.offset, reply.data.size() - reply.offset);
+            if (n < 0) {
+                broken = errno != EAGAIN && errno != EINTR;
+                break;
+            }
+            reply.offset += n;
+            if (reply.offset < reply.data.size()) break;
+            out.pop_front();
+        }
+        if (broken) break;
+    }
+    close(fd);
+
+    cout << "client " << client << ": " << stats.messages << " messages, " << stats.encrypted << " encrypted, "
+         << stats.decrypted << " decrypted blocks" << endl;
+    return;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *env = getenv("WEM_ORACLE");
+    std::string path = env && *env ? env : "/tmp/wem-oracle.sock";
+    long latencyUs = 0;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "--socket" && hasValue) path = argv[++i];
+        else if (arg == "--latency-us" && hasValue) latencyUs = atol(argv[++i]);
+        else {
+            std::cerr << "usage: " << argv[0] << " [--socket PATH] [--latency-us N]" << endl;
+            return 1;
+        }
+    }
+
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "oracled: socket path too long" << endl;
+        return 1;
+    }
+    strcpy(addr.sun_path, path.c_str());
+
+    const int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(path.c_str());
+    if (listener < 0 || bind(listener, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0 || listen(listener, 4) < 0) {
+        std::cerr << "oracled: " << path << ": " << strerror(errno) << endl;
+        return 1;
+    }
+    signal(SIGPIPE, SIG_IGN);
+    cout << "listening on " << path << ", latency " << latencyUs << " us" << endl;
+
+    for (int client = 0; ; ++client) {
+        const int fd = accept(listener, nullptr, nullptr);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "oracled: accept: " << strerror(errno) << endl;
+            return 1;
+        }
+        serve(fd, std::chrono::microseconds(latencyUs), client);
+    }
+}
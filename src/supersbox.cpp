@@ -1,6 +1,10 @@
 #include "crypto/AES/AES128_ni.h"
+#include "crypto/AES/AESCTR.h"
 #include "crypto/GF/GF28.h"
+#include "crypto/linalg/GF28Matrix.h"
 #include "crypto/utils/component.h"
+#include "crypto/WEM/SuperSbox.h"
+#include "crypto/WEM/RemoteOracle.h"
 
 #include <iostream>
 #include <iomanip>
@@ -9,7 +13,6 @@
 #include <bitset>
 #include <vector>
 #include <functional>
-#include <random>
 #include <algorithm>
 #include <queue>
 #include <cassert>
@@ -45,27 +48,23 @@ static void printx(const std::array<unsigned char, 4> s)
 }
 
 
-static void generateMatrix(unsigned char mat[32][4])
+static void generateMatrix(unsigned char mat[32][4], AESCTR& rng)
 {
     unsigned int m[32];
     for (int i = 0; i < 32; ++i)
         m[i] = (1 << i);
 
-    random_device rd;
-    default_random_engine randomGen(rd());
-    uniform_int_distribution<int> dist(0, 31);
-
     for (int i = 0; i < nrand; ++i) {
         // swap
-        int row1 = static_cast<int>(dist(randomGen));
-        int row2 = static_cast<int>(dist(randomGen));
+        int row1 = static_cast<int>(rng.bounded(32));
+        int row2 = static_cast<int>(rng.bounded(32));
         int tmp = m[row1];
         m[row1] = m[row2];
         m[row2] = tmp;
 
         // add
-        row1 = static_cast<int>(dist(randomGen));
-        row2 = static_cast<int>(dist(randomGen));
+        row1 = static_cast<int>(rng.bounded(32));
+        row2 = static_cast<int>(rng.bounded(32));
         if (row1 == row2) continue;
         m[row1] = m[row1] ^ m[row2];
     }
@@ -75,60 +74,6 @@ static void generateMatrix(unsigned char mat[32][4])
     return;
 }
 
-static void supersbox(unsigned char ciphertext[4], const unsigned char plaintext[4], const unsigned char mat[32][4], const unsigned char invsbox[256])
-{
-    auto invAESSbox = component::getAESInvSbox();
-
-    memcpy(ciphertext, plaintext, 4);
-
-    // inv affine A
-    unsigned int ciphernum = 0;
-    for (int row = 32 - 1; row >= 0; --row) {
-        unsigned char bit = mat[row][0] & ciphertext[0];
-        bit ^= mat[row][1] & ciphertext[1];
-        bit ^= mat[row][2] & ciphertext[2];
-        bit ^= mat[row][3] & ciphertext[3];
-
-        bit ^= (bit >> 4);
-        bit ^= (bit >> 2);
-        bit ^= (bit >> 1);
-
-        ciphernum = (ciphernum << 1) | (bit & 1);
-    }
-    ciphertext[0] = (ciphernum >>  0) & 0xff;
-    ciphertext[1] = (ciphernum >>  8) & 0xff;
-    ciphertext[2] = (ciphernum >> 16) & 0xff;
-    ciphertext[3] = (ciphernum >> 24) & 0xff;
-
-    // inv aes sbox
-    for (int i = 0; i < 4; ++i) ciphertext[i] = invAESSbox[ciphertext[i]];
-
-    // inv ark1
-    ciphertext[0] ^= 0x62;
-    ciphertext[1] ^= 0x63;
-    ciphertext[2] ^= 0x63;
-    ciphertext[3] ^= 0x63;
-
-    // inv mc
-    unsigned char state[4];
-    memcpy(state, ciphertext, 4);
-
-    const unsigned char tmpState = state[0] ^ state[1] ^ state[2] ^ state[3];
-    ciphertext[0] = state[0] ^ GF28::mul(0x09, tmpState) ^ GF28::mul(0x04, state[0] ^ state[2]) ^ GF28::mul(0x02, state[0] ^ state[1]);
-    ciphertext[1] = state[1] ^ GF28::mul(0x09, tmpState) ^ GF28::mul(0x04, state[1] ^ state[3]) ^ GF28::mul(0x02, state[1] ^ state[2]);
-    ciphertext[2] = state[2] ^ GF28::mul(0x09, tmpState) ^ GF28::mul(0x04, state[0] ^ state[2]) ^ GF28::mul(0x02, state[2] ^ state[3]);
-    ciphertext[3] = state[3] ^ GF28::mul(0x09, tmpState) ^ GF28::mul(0x04, state[1] ^ state[3]) ^ GF28::mul(0x02, state[3] ^ state[0]);
-
-
-    // inv aes sbox
-    for (int i = 0; i < 4; ++i) ciphertext[i] = invAESSbox[ciphertext[i]];
-
-    // inv secret sbox
-    for (int i = 0; i < 4; ++i) ciphertext[i] = invsbox[ciphertext[i]];
-
-    return;
-}
-
 static void checkcheck(const vector< array<unsigned char, 4> > cs, const unsigned char mat[32][4], const unsigned char invsbox[256])
 {
     unsigned char tmpSum[4] = { 0x00, 0x00, 0x00, 0x00 };
@@ -234,50 +179,56 @@ static void info(string s)
     return;
 }
 
-bool recoverSbox(unsigned char secretKey[16])
+bool recoverSbox(unsigned char secretKey[16], AESCTR& rng, RemoteOracle *remote)
 {
     info("Setup oracle");
 
     unsigned char mat[32][4];
-    generateMatrix(mat);
+    generateMatrix(mat, rng);
 
     unsigned char ssb[256];
     unsigned char invssb[256];
-    component::generateBox(ssb, invssb, secretKey, 0);
+    component::generateBox(ssb, invssb, secretKey);
 
-    auto oracle = bind(&supersbox, placeholders::_1, placeholders::_2, mat, invssb); // decryption oracle
+    // decryption oracle, in process or on oracled under the same key and matrix
+    if (remote) remote->setup(oracleProtocol::superSboxSetup(secretKey, mat));
+    auto oracle = [&](unsigned char plaintext[][4], const unsigned char ciphertext[][4], int n) {
+        if (remote) remote->decrypt(plaintext[0], ciphertext[0], n);
+        else superSbox::decrypt(plaintext, ciphertext, n, mat, invssb);
+        return;
+    };
 
     info("Start Attack");
-    bitset<VARNUM> eqs[QNUM];
+    // GF(2) system, kept as 0/1 entries so elimination never leaves GF(2)
+    GF28Matrix eqs(QNUM, VARNUM);
     vector< array<unsigned char, 4> > ps[QNUM];
     vector< array<unsigned char, 4> > cs[QNUM];
 
-    for (int j = 0; j < QNUM; ++j)
-        eqs[j].reset();
-
     info("Query oracle");
-    unsigned char plaintext[4];
-    unsigned char ciphertext[4];
+    // one oracle call per structure of 256 ciphertexts
+    unsigned char plaintext[256][4];
+    unsigned char ciphertext[256][4];
     int eqCnt = 0;
     while (eqCnt < QNUM - 4) {
-        ciphertext[1] = static_cast<unsigned char>((eqCnt + 0) & 0xdd); // randomly choose
-        ciphertext[2] = static_cast<unsigned char>((eqCnt + 1) & 0xee); // randomly choose
-        ciphertext[3] = static_cast<unsigned char>((eqCnt + 2) & 0xff); // randomly choose
-
         for (int j = 0x00; j <= 0xff; ++j) {
-            ciphertext[0] = static_cast<unsigned char>(j & 0xff);
-            
-            oracle(plaintext, ciphertext);
+            ciphertext[j][0] = static_cast<unsigned char>(j & 0xff);
+            ciphertext[j][1] = static_cast<unsigned char>((eqCnt + 0) & 0xdd); // randomly choose
+            ciphertext[j][2] = static_cast<unsigned char>((eqCnt + 1) & 0xee); // randomly choose
+            ciphertext[j][3] = static_cast<unsigned char>((eqCnt + 2) & 0xff); // randomly choose
+        }
 
+        oracle(plaintext, ciphertext, 256);
+
+        for (int j = 0x00; j <= 0xff; ++j) {
             for (int b = 0; b < 4; ++b)
-                eqs[eqCnt + b].flip(plaintext[b]);
+                eqs[eqCnt + b][plaintext[j][b]] ^= 0x01;
 
             array<unsigned char, 4>  tmpArray;
-            for (int tt = 0; tt < 4; ++tt) tmpArray[tt] = plaintext[tt];
+            for (int tt = 0; tt < 4; ++tt) tmpArray[tt] = plaintext[j][tt];
             ps[eqCnt / 4].push_back(tmpArray);
 
             array<unsigned char, 4>  tmpArray2;
-            for (int tt = 0; tt < 4; ++tt) tmpArray2[tt] = ciphertext[tt];
+            for (int tt = 0; tt < 4; ++tt) tmpArray2[tt] = ciphertext[j][tt];
             cs[eqCnt / 4].push_back(tmpArray2);
         }
 
@@ -285,44 +236,8 @@ bool recoverSbox(unsigned char secretKey[16])
     }
 
     info("Gauss Elimination");
-    int rank = 0;
-    eqs[0].flip();
-    for (int col = 0, firstRow = 0; col < VARNUM; ++col) {
-        bool hasOne = false;
-
-        for (int row = firstRow; row < QNUM; ++row)
-            if (eqs[row].test(col)) {
-                auto tmp = eqs[row];
-                eqs[row] = eqs[firstRow];
-                eqs[firstRow] = tmp;
-                hasOne = true;
-                break;
-            }
-
-        if (!hasOne) continue;
-
-        ++rank;
-        for (int row = 0; row < QNUM; ++row)
-            if (eqs[row].test(col) && row != firstRow)
-                eqs[row] = eqs[row] ^ eqs[firstRow];
-
-        ++firstRow;
-    }
-    // Triangle form
-    int oneRow;
-    for (oneRow = VARNUM - 1; oneRow >= 0; --oneRow)
-        if (eqs[oneRow].any()) break;
-    while (!eqs[oneRow].test(oneRow)) {
-        for (int i = oneRow - 1; i < 256; ++i)
-            if (eqs[oneRow].test(i)) {
-                auto tmp = eqs[i];
-                eqs[i] = eqs[oneRow];
-                eqs[oneRow] = tmp;
-                break;
-            }
-
-        --oneRow;
-    }
+    for (int col = 0; col < VARNUM; ++col) eqs[0][col] ^= 0x01;
+    const int rank = eqs.rref();
 
     for (int i = 0; i < 256; ++i) {
         auto aesSbox = component::getAESSbox();
@@ -347,12 +262,12 @@ bool recoverSbox(unsigned char secretKey[16])
     z3::solver z3solver(z3ctx);
     z3solver.add(z3::distinct(z3p));
 
-    for (int i = 0; i < VARNUM; ++i) {
-        if (!eqs[i].test(i)) continue;
-
-        auto z3tmp = z3p[i];
-        for (int j = i + 1; j < VARNUM; ++j)
-            if (eqs[i].test(j)) {
+    // pivot row r: p_pivot ^ sum of p_j over the free columns j it holds = 0
+    for (int r = 0; r < rank; ++r) {
+        const int pivot = eqs.pivots()[r];
+        auto z3tmp = z3p[pivot];
+        for (int j = pivot + 1; j < VARNUM; ++j)
+            if (eqs[r][j]) {
                 z3tmp = z3::to_expr(z3ctx, z3tmp ^ z3p[j]);
             }
         z3solver.add(z3tmp == 0);
@@ -493,16 +408,17 @@ bool recoverSbox(unsigned char secretKey[16])
 
 int main()
 {
-    random_device rd;
-    default_random_engine randomGen(rd());
-    uniform_int_distribution<int> dist(0, 255);
+    const auto seed = AESCTR::defaultSeed();
+    auto rng = AESCTR::fromSeed(seed);
+    cout << "seed " << seed << endl;
     unsigned char secretKey[16];
-    for (int i = 0; i < 16; ++i) secretKey[i] = static_cast<unsigned char>(dist(randomGen));
+    rng.fill(secretKey, 16);
 
+    auto remote = RemoteOracle::fromEnvironment();
     auto start = std::chrono::high_resolution_clock::now();
 
     for (int i = 0; i < 1000; ++i) {
-        bool isSolved = recoverSbox(secretKey);
+        bool isSolved = recoverSbox(secretKey, rng, remote.get());
         if (isSolved)
             break;
     }